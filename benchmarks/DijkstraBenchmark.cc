@@ -0,0 +1,186 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+
+//
+// Microbenchmark of the Dijkstra priority queues on Walker +Grid tori.
+//
+// Usage: DijkstraBenchmark [planes x satellites ...], e.g. 8x6 36x36
+// Without arguments the grids from 48 to 40,000 nodes are measured.
+//
+// For every grid one single-source search is timed with
+//  - the sorted std::list queue that Topology used before the indexed heap
+//    (reproduced here over the CSR arrays, as the baseline),
+//  - Topology::calculateWeightedSingleShortestPathsFrom() (pointer graph,
+//    indexed heap),
+//  - CsrGraph::calculateShortestPathsFrom() (adjacency arrays, indexed heap).
+// The distances of the three searches are compared for every source.
+//
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <vector>
+
+#include "satellite/routing/CsrGraph.h"
+#include "satellite/routing/Topology.h"
+
+using namespace leolab;
+
+namespace {
+
+struct Grid {
+    int numPlanes;
+    int numSatsPerPlane;
+};
+
+/**
+ * Builds a +Grid torus: every satellite links to its neighbours in the same
+ * plane and in the adjacent planes. Link weights are mildly uneven, so that
+ * ties do not dominate the queue operations.
+ */
+std::vector<Topology::Node *> buildPlusGrid(Topology& topology, const Grid& grid)
+{
+    int numNodes = grid.numPlanes * grid.numSatsPerPlane;
+    std::vector<Topology::Node *> nodes;
+    nodes.reserve(numNodes);
+    for (int i = 0; i < numNodes; i++) {
+        Topology::Node *node = new Topology::Node(i + 1);
+        topology.addNode(node);
+        nodes.push_back(node);
+    }
+    auto index = [&](int plane, int slot) {
+        plane = (plane + grid.numPlanes) % grid.numPlanes;
+        slot = (slot + grid.numSatsPerPlane) % grid.numSatsPerPlane;
+        return plane * grid.numSatsPerPlane + slot;
+    };
+    for (int plane = 0; plane < grid.numPlanes; plane++) {
+        for (int slot = 0; slot < grid.numSatsPerPlane; slot++) {
+            int neighbours[4] = { index(plane, slot + 1), index(plane + 1, slot), index(plane, slot - 1), index(plane - 1, slot) };
+            for (int k = 0; k < 4; k++) {
+                double weight = 1.0 + 0.001 * ((plane * 7 + slot * 3 + k) % 17);
+                topology.addLink(new Topology::Link(weight), nodes[index(plane, slot)], nodes[neighbours[k]]);
+            }
+        }
+    }
+    return nodes;
+}
+
+/**
+ * The former Topology search: a std::list kept sorted by distance, with a
+ * linear scan to insert and a removal on every decrease-key.
+ */
+void listQueueShortestPathsFrom(const CsrGraph& graph, int source, std::vector<double>& dist)
+{
+    dist.assign(graph.getNumNodes(), INFINITY);
+    dist[source] = 0;
+    std::list<int> q;
+    q.push_back(source);
+    while (!q.empty()) {
+        int u = q.front();
+        q.pop_front();
+        int end = graph.getFirstOutEdge(u) + graph.getNumOutEdges(u);
+        for (int e = graph.getFirstOutEdge(u); e < end; e++) {
+            int v = graph.getEdgeDestination(e);
+            double newDist = dist[u] + graph.getEdgeWeight(e);
+            if (dist[v] > newDist) {
+                if (dist[v] != INFINITY)
+                    q.remove(v);
+                dist[v] = newDist;
+                auto it = q.begin();
+                for (; it != q.end(); ++it)
+                    if (dist[*it] > newDist)
+                        break;
+                q.insert(it, v);
+            }
+        }
+    }
+}
+
+template <typename F>
+double measure(int repetitions, F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; r++)
+        f(r);
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / repetitions;
+}
+
+void printTime(double us)
+{
+    if (us < 1000)
+        printf(" %12.1f us", us);
+    else
+        printf(" %12.2f ms", us / 1000);
+}
+
+bool sameDistances(const std::vector<double>& a, const std::vector<double>& b)
+{
+    for (size_t i = 0; i < a.size(); i++)
+        if (std::fabs(a[i] - b[i]) > 1e-9)
+            return false;
+    return a.size() == b.size();
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::vector<Grid> grids;
+    for (int i = 1; i < argc; i++) {
+        Grid grid;
+        if (sscanf(argv[i], "%dx%d", &grid.numPlanes, &grid.numSatsPerPlane) != 2 || grid.numPlanes < 1 || grid.numSatsPerPlane < 1) {
+            fprintf(stderr, "Invalid grid '%s', expected <planes>x<satellites per plane>\n", argv[i]);
+            return 1;
+        }
+        grids.push_back(grid);
+    }
+    if (grids.empty())
+        grids = { { 8, 6 }, { 36, 36 }, { 100, 100 }, { 200, 200 } };
+
+    printf("%8s %15s %15s %15s\n", "nodes", "list queue", "heap (Topology)", "heap (CsrGraph)");
+    bool ok = true;
+    for (const Grid& grid : grids) {
+        Topology topology("benchmark");
+        std::vector<Topology::Node *> nodes = buildPlusGrid(topology, grid);
+        const CsrGraph& graph = topology.getCsrGraph();
+        int numNodes = nodes.size();
+        int repetitions = numNodes <= 1296 ? 50 : numNodes <= 10000 ? 5 : 2;
+
+        std::vector<double> listDist;
+        double listTime = measure(repetitions, [&](int r) { listQueueShortestPathsFrom(graph, r % numNodes, listDist); });
+        double topologyTime = measure(repetitions, [&](int r) { topology.calculateWeightedSingleShortestPathsFrom(nodes[r % numNodes]); });
+        CsrGraph::ShortestPathTree tree;
+        double csrTime = measure(repetitions, [&](int r) { graph.calculateShortestPathsFrom(r % numNodes, tree); });
+
+        // the last source of every measurement is the same, compare the results
+        std::vector<double> topologyDist(numNodes);
+        for (int i = 0; i < numNodes; i++)
+            topologyDist[i] = nodes[i]->getDistanceToTarget();
+        if (!sameDistances(listDist, topologyDist) || !sameDistances(listDist, tree.dist)) {
+            fprintf(stderr, "Distances differ on the %d node grid\n", numNodes);
+            ok = false;
+        }
+
+        printf("%8d", numNodes);
+        printTime(listTime);
+        printTime(topologyTime);
+        printTime(csrTime);
+        printf("\n");
+    }
+    return ok ? 0 : 1;
+}
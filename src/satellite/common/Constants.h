@@ -0,0 +1,16 @@
+#ifndef SATELLITE_CONSTANTS_H_
+#define SATELLITE_CONSTANTS_H_
+
+// 物理常量；不依赖 OMNeT++/INET，以 -ffast-math 编译的 ConstellationPropagator 只包含本文件和标准库
+
+namespace leolab {
+
+// 球形地球半径 (km)，轨道、星下点和地面终端位置的计算共用
+constexpr double EARTH_RADIUS_KM = 6371.0;
+
+// 光速 (m/s)，与 DynamicChannel 的默认传播速度一致
+constexpr double SPEED_OF_LIGHT = 299792458.0;
+
+} // namespace leolab
+
+#endif /* SATELLITE_CONSTANTS_H_ */
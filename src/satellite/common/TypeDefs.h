@@ -2,6 +2,7 @@
 #define SATELLITE_TYPEDEFS_H_
 
 #include "inet/common/INETDefs.h"
+#include "Constants.h"
 
 namespace leolab {
 
@@ -12,14 +13,30 @@ class GeodeticPosition : public cObject {
     double longitude;  // 经度 (度)
     double latitude;   // 纬度 (度)  
     double altitude;   // 高度 (km)
+    double x, y, z;    // 地心地固（ECEF）直角坐标 (m)，与经纬高同时更新
     simtime_t timestamp;
 
     // 默认构造函数
-    GeodeticPosition() : longitude(0), latitude(0), altitude(0), timestamp(0) {}
+    GeodeticPosition() : longitude(0), latitude(0), altitude(0), timestamp(0) { updateCartesian(); }
     
     // 带参数的构造函数
     GeodeticPosition(double lon, double lat, double alt) : 
-        longitude(lon), latitude(lat), altitude(alt), timestamp(simTime()) {}
+        longitude(lon), latitude(lat), altitude(alt), timestamp(simTime()) { updateCartesian(); }
+
+    // 由经纬高重新计算直角坐标（直接写入经纬高后调用）
+    void updateCartesian() {
+        double lon = longitude * M_PI / 180, lat = latitude * M_PI / 180;
+        double r = (EARTH_RADIUS_KM + altitude) * 1000.0;
+        x = r * cos(lat) * cos(lon);
+        y = r * cos(lat) * sin(lon);
+        z = r * sin(lat);
+    }
+
+    // 两点之间的直线距离 (m)
+    double distanceTo(const GeodeticPosition& other) const {
+        double dx = x - other.x, dy = y - other.y, dz = z - other.z;
+        return sqrt(dx * dx + dy * dy + dz * dz);
+    }
     
     virtual std::string str() const override {
         std::stringstream ss;
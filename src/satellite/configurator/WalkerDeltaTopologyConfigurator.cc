@@ -15,14 +15,14 @@
 
 #include "WalkerDeltaTopologyConfigurator.h"
 
+#include <sstream>
+
 namespace leolab {
     
 using namespace math;
 
 Define_Module(WalkerDeltaTopologyConfigurator);
 
-const double EARTH_RADIUS_M = 6371000.0;
-
 WalkerDeltaTopologyConfigurator::WalkerDeltaTopologyConfigurator() {}
 
 WalkerDeltaTopologyConfigurator::~WalkerDeltaTopologyConfigurator() {}
@@ -46,6 +46,9 @@ void WalkerDeltaTopologyConfigurator::initialize(int stage) {
         F = network->par("F").intValue();
         numGroundHosts = network->par("numGroundHosts").intValue();
         datarate = par("datarate").doubleValue();
+
+        if (par("planeAddresses").boolValue())
+            configurePlaneAddresses();
         
         initSatellitePosition();
         createFourLinks();
@@ -92,6 +95,9 @@ void WalkerDeltaTopologyConfigurator::updateGroundToSatelliteLinks() {
         int currentIdx = -1;
         double currentDistance = DBL_MAX;
         bool isUpdate = false;
+
+        // 终端位置在本轮扫描中不变，只换算一次直角坐标
+        GeodeticPosition terminalPosition = getGeodeticPosition(terminalModule);
         
         // 检查gate是否连接
         if (terminalGate->isConnected()) {
@@ -101,7 +107,7 @@ void WalkerDeltaTopologyConfigurator::updateGroundToSatelliteLinks() {
                 cModule* satelliteModule = connectedGate->getOwnerModule();
                 if (satelliteModule) {
                     currentIdx = satelliteModule->getIndex();
-                    currentDistance = calculateDistance(terminalModule, satelliteModule);
+                    currentDistance = terminalPosition.distanceTo(getGeodeticPosition(satelliteModule));
                     EV_DEBUG << "Terminal [" << i << "] currently connected to satellite [" << currentIdx 
                              << "], distance: " << currentDistance << endl;
                 } else {
@@ -120,10 +126,10 @@ void WalkerDeltaTopologyConfigurator::updateGroundToSatelliteLinks() {
             if (!satelliteGate) continue;
             
             if (!satelliteGate->isConnected()) {
-                double distance = calculateDistance(terminalModule, satelliteModule);
+                double distance = terminalPosition.distanceTo(getGeodeticPosition(satelliteModule));
                 if (currentDistance > distance) {
                     currentIdx = k;
-                    currentDistance = calculateDistance(terminalModule, satelliteModule);
+                    currentDistance = distance;
                 }
             }
         }
@@ -210,6 +216,46 @@ void WalkerDeltaTopologyConfigurator::updateGroundToSatelliteLinks() {
     EV_INFO << "=== Finished updating ground to satellite links ===" << endl;
 }
 
+void WalkerDeltaTopologyConfigurator::configurePlaneAddresses() {
+    int N = numPlane, M = numSatellites / numPlane;
+    if (N * M != numSatellites) {
+        throw cRuntimeError("%d satellites cannot be divided into %d equal parts\n", numSatellites, numPlane);
+    }
+    // 轨道面编号占第二个字节（0 留给星间链路的 10.0.x.x），轨道内编号占第三个字节
+    if (N > 255 || M > 256) {
+        throw cRuntimeError("Plane address plan supports at most 255 planes of 256 satellites, got %d planes of %d", N, M);
+    }
+
+    // Ipv4NetworkConfigurator 在本地初始化阶段读取 config，因此本模块须在其之前初始化
+    cModule *ipv4Configurator = getModuleByPath(par("ipv4ConfiguratorModule").stringValue());
+    if (ipv4Configurator == nullptr || !ipv4Configurator->hasPar("config")) {
+        throw cRuntimeError("Ipv4 configurator module '%s' not found", par("ipv4ConfiguratorModule").stringValue());
+    }
+    // 同一网络中的子模块按声明顺序创建（模块 ID 递增）并逐阶段初始化
+    if (ipv4Configurator->getParentModule() == getParentModule() && ipv4Configurator->getId() < getId()) {
+        throw cRuntimeError("%s is declared before %s, the plane address plan would be ignored", ipv4Configurator->getFullPath().c_str(), getFullPath().c_str());
+    }
+    cPar& config = ipv4Configurator->par("config");
+
+    // 每颗卫星一条 eth4 规则，排在配置器原有规则之前（配置器取第一条匹配的规则）
+    std::ostringstream xml;
+    xml << "<config>";
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < M; ++j) {
+            xml << "<interface hosts='" << satelliteModuleName << "[" << getIdx(N, M, i, j) << "]' names='eth4' address='10."
+                << i + 1 << "." << j << ".x' netmask='255.255.255.x'/>";
+        }
+    }
+    if (cXMLElement *original = config.xmlValue()) {
+        for (cXMLElement *child = original->getFirstChild(); child; child = child->getNextSibling())
+            xml << child->getXML();
+    }
+    xml << "</config>";
+    config.setXMLValue(getEnvir()->getParsedXMLString(xml.str().c_str()));
+
+    EV_INFO << "Generated eth4 address rules for " << N << " planes of " << M << " satellites" << endl;
+}
+
 void WalkerDeltaTopologyConfigurator::initSatellitePosition() {
     int N = numPlane, M = numSatellites / numPlane;
     if (N * M != numSatellites) {
@@ -310,59 +356,17 @@ cDatarateChannel* WalkerDeltaTopologyConfigurator::createDynamicChannel(
     return channel;
 }
 
-double WalkerDeltaTopologyConfigurator::calculateDistance(cModule* node1, cModule* node2) {
-
-    double lon1, lat1, alt1, lon2, lat2, alt2;
-
-    if (node1->hasPar("longitude") && node1->hasPar("latitude") && node1->hasPar("altitude")) {
-        lon1 = node1->par("longitude").doubleValue();
-        lat1 = node1->par("latitude").doubleValue();
-        alt1 = node1->par("altitude").doubleValue();
-    }
-    else {
-        CircularOrbitMobility* nodeMobility = dynamic_cast<CircularOrbitMobility *>(node1->getSubmodule("mobility"));
-        const GeodeticPosition* satelliteGeoPos = nodeMobility->getCurrentGeoPos();
-        lon1 = satelliteGeoPos->longitude;
-        lat1 = satelliteGeoPos->latitude;
-        alt1 = satelliteGeoPos->altitude;
-    }
-    
-    if (node2->hasPar("longitude") && node2->hasPar("latitude") && node2->hasPar("altitude")) {
-        lon2 = node2->par("longitude").doubleValue();
-        lat2 = node2->par("latitude").doubleValue();
-        alt2 = node2->par("altitude").doubleValue();
-    }
-    else {
-        CircularOrbitMobility* nodeMobility = dynamic_cast<CircularOrbitMobility *>(node2->getSubmodule("mobility"));
-        const GeodeticPosition* satelliteGeoPos = nodeMobility->getCurrentGeoPos();
-        lon2 = satelliteGeoPos->longitude;
-        lat2 = satelliteGeoPos->latitude;
-        alt2 = satelliteGeoPos->altitude;
+GeodeticPosition WalkerDeltaTopologyConfigurator::getGeodeticPosition(cModule* node) {
+    // 地面终端由模块参数给出经纬高，卫星读取其移动性模块的当前位置（已带直角坐标）
+    if (node->hasPar("longitude") && node->hasPar("latitude") && node->hasPar("altitude")) {
+        return GeodeticPosition(node->par("longitude").doubleValue(), node->par("latitude").doubleValue(), node->par("altitude").doubleValue());
     }
+    CircularOrbitMobility* nodeMobility = dynamic_cast<CircularOrbitMobility *>(node->getSubmodule("mobility"));
+    return *nodeMobility->getCurrentGeoPos();
+}
 
-    // 将角度转换为弧度
-    double lat1_rad = math::deg2rad(lat1);
-    double lon1_rad = math::deg2rad(lon1);
-    double lat2_rad = math::deg2rad(lat2);
-    double lon2_rad = math::deg2rad(lon2);
-    
-    // 计算空间直线距离（考虑地球曲率和卫星高度）
-    double r1 = EARTH_RADIUS_M + alt1 * 1000.0;  // 转换为米
-    double r2 = EARTH_RADIUS_M + alt2 * 1000.0;
-    
-    // 球坐标转直角坐标
-    double x1 = r1 * cos(lat1_rad) * cos(lon1_rad);
-    double y1 = r1 * cos(lat1_rad) * sin(lon1_rad);
-    double z1 = r1 * sin(lat1_rad);
-    
-    double x2 = r2 * cos(lat2_rad) * cos(lon2_rad);
-    double y2 = r2 * cos(lat2_rad) * sin(lon2_rad);
-    double z2 = r2 * sin(lat2_rad);
-    
-    // 欧几里得距离
-    double distance = sqrt(pow(x2 - x1, 2) + pow(y2 - y1, 2) + pow(z2 - z1, 2));
-    
-    return distance;
+double WalkerDeltaTopologyConfigurator::calculateDistance(cModule* node1, cModule* node2) {
+    return getGeodeticPosition(node1).distanceTo(getGeodeticPosition(node2));
 }
 
 }
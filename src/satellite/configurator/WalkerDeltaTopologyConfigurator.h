@@ -52,6 +52,7 @@ class WalkerDeltaTopologyConfigurator : public cSimpleModule {
         int numGroundHosts;
         double datarate;
 
+        void configurePlaneAddresses();
         void initSatellitePosition();
         void createFourLinks();
         void updateGroundToSatelliteLinks();
@@ -63,9 +64,10 @@ class WalkerDeltaTopologyConfigurator : public cSimpleModule {
             cGate* destInGate, 
             const char* channelName = nullptr, 
             double datarate = 1e9,
-            double propagationSpeed = 299792458.0,
+            double propagationSpeed = SPEED_OF_LIGHT,
             double minUpdateInterval = 0.1
         );
+        GeodeticPosition getGeodeticPosition(cModule* node);
         double calculateDistance(cModule* terminal, cModule* satellite);
 
   	protected:
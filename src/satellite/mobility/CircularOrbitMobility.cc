@@ -15,6 +15,7 @@
 
 #include "CircularOrbitMobility.h"
 #include "inet/common/INETMath.h"
+#include "inet/common/ModuleAccess.h"
 
 namespace leolab {
 
@@ -23,7 +24,6 @@ Define_Module(CircularOrbitMobility);
 using namespace inet;
 using namespace math;
 
-const double EARTH_RADIUS_KM = 6371.0;
 const double GM = 3.986004418e5;
 
 CircularOrbitMobility::CircularOrbitMobility() {
@@ -56,6 +56,13 @@ void CircularOrbitMobility::initialize(int stage) {
     EV_TRACE << "initializing CircularOrbitMobility stage " << stage << endl;
 
     if (stage == INITSTAGE_LOCAL) {
+        // 惰性模式和节拍模式不安排周期性计时器（updateInterval 为 0 时 MovingMobilityBase 不调度自消息）
+        constellation.reference(this, "constellationModule", false);
+        lazy = par("lazy");
+        tickDriven = isTickDriven();
+        if (lazy || tickDriven)
+            updateInterval = 0;
+
         // 注册信号为“geodeticPositionChanged”
         // geodeticPositionChangedSignal = cComponent::registerSignal("geodeticPositionChanged");
         initParamerers();
@@ -73,9 +80,23 @@ void CircularOrbitMobility::initParamerers() {
     rightAscension = par("rightAscension").doubleValue();
     earthRotationRate = par("earthRotationRate").doubleValue();
 
-    double radius = EARTH_RADIUS_KM + altitude;
-    double period = 2 * M_PI * sqrt(pow(radius, 3) / GM);
-    omega = 2 * M_PI / period;
+    omega = computeAngularVelocity(altitude);
+
+    // 登记到星座位置服务（配置器改写轨道参数后会再次调用本函数，此时只更新参数）
+    constellation.reference(this, "constellationModule", false);
+    if (constellation.get() != nullptr) {
+        ConstellationPropagator::Elements elements;
+        elements.initPhase = initPhase;
+        elements.alpha = alpha;
+        elements.altitude = altitude;
+        elements.rightAscension = rightAscension;
+        elements.earthRotationRate = earthRotationRate;
+        elements.omega = omega;
+        if (constellationIndex == -1)
+            constellationIndex = constellation->registerSatellite(this, elements);
+        else
+            constellation->setElements(constellationIndex, elements);
+    }
 
     constraintAreaCenter = Coord((constraintAreaMax.x + constraintAreaMin.x) / 2, 
                                 (constraintAreaMax.y + constraintAreaMin.y) / 2, 
@@ -88,26 +109,58 @@ void CircularOrbitMobility::setInitialPosition() {
     move();
 }
 
-void CircularOrbitMobility::move() {
+double CircularOrbitMobility::computeAngularVelocity(double altitude) {
+    double radius = EARTH_RADIUS_KM + altitude;
+    double period = 2 * M_PI * sqrt(pow(radius, 3) / GM);
+    return 2 * M_PI / period;
+}
+
+void CircularOrbitMobility::computeOrbitAngles(double initPhase, double alpha, double rightAscension, double earthRotationRate,
+                                               double omega, double t, double& phase, double& longitude, double& latitude) {
     // 基于仿真时间计算相位
     // ...
-    phase = initPhase + omega * simTime().dbl();
+    phase = initPhase + omega * t;
     while(phase > 2 * M_PI) phase -= 2 * M_PI;  // 避免phase无限累积
 
     // 计算经度
     // ...
-//    longitude = atan(cos(alpha) * tan(phase)) + rightAscension - earthRotationRate * simTime().dbl();
+//    longitude = atan(cos(alpha) * tan(phase)) + rightAscension - earthRotationRate * t;
 //    while (longitude >  2 * M_PI)  longitude -= 2 * M_PI;   // 避免longitude无限累积
     if (phase >= M_PI / 2 && phase < 3 * M_PI / 2) {
-        longitude = atan(cos(alpha) * tan(phase)) + rightAscension - earthRotationRate * simTime().dbl() + M_PI;
+        longitude = atan(cos(alpha) * tan(phase)) + rightAscension - earthRotationRate * t + M_PI;
     }
     else {
-        longitude = atan(cos(alpha) * tan(phase)) + rightAscension - earthRotationRate * simTime().dbl();
+        longitude = atan(cos(alpha) * tan(phase)) + rightAscension - earthRotationRate * t;
     }
 
     // 计算纬度
     // ...
     latitude = asin(sin(alpha) * sin(phase));
+}
+
+GeodeticPosition CircularOrbitMobility::computePosition(double initPhase, double alpha, double altitude, double rightAscension,
+                                                        double earthRotationRate, double omega, double t) {
+    double phase, longitude, latitude;
+    computeOrbitAngles(initPhase, alpha, rightAscension, earthRotationRate, omega, t, phase, longitude, latitude);
+    GeodeticPosition position;
+    position.longitude = rad2deg(longitude);
+    position.latitude = rad2deg(latitude);
+    position.altitude = altitude;
+    position.updateCartesian();
+    return position;
+}
+
+void CircularOrbitMobility::move() {
+    const ConstellationPropagator *propagator = nullptr;
+    if (constellation.get() != nullptr) {
+        // 同一时刻全部卫星只批量计算一次
+        propagator = &constellation->update(simTime());
+        phase = propagator->getPhase(constellationIndex);
+        longitude = propagator->getLongitude(constellationIndex);
+        latitude = propagator->getLatitude(constellationIndex);
+    }
+    else
+        computeOrbitAngles(initPhase, alpha, rightAscension, earthRotationRate, omega, simTime().dbl(), phase, longitude, latitude);
 
     // 将经纬度映射至2D平面
     lastPosition.x = constraintAreaCenter.x + longitude * (constraintAreaMax.x - constraintAreaMin.x) / (2 * M_PI);
@@ -118,21 +171,52 @@ void CircularOrbitMobility::move() {
     Coord dummyCoord;
     handleIfOutside(WRAP, dummyCoord, dummyCoord);
 
-    // 更新经纬度信息对象
+    // 更新经纬度信息对象，同时给出直角坐标，使用者求距离时不再做三角运算
     currentGeoPos->longitude = rad2deg(longitude);
     currentGeoPos->latitude = rad2deg(latitude);
     currentGeoPos->altitude = altitude;
+    if (propagator != nullptr) {
+        currentGeoPos->x = propagator->getX(constellationIndex);
+        currentGeoPos->y = propagator->getY(constellationIndex);
+        currentGeoPos->z = propagator->getZ(constellationIndex);
+    }
+    else
+        currentGeoPos->updateCartesian();
     currentGeoPos->timestamp = simTime();
     
-    // 发射包含经纬度对象的信号
+    // 发射包含经纬度对象的信号；节拍模式下由星座位置服务统一发出一次 constellationMovedSignal
     // ...
-    emit(geodeticPositionChangedSignal, currentGeoPos);
+    if (!tickDriven)
+        emit(geodeticPositionChangedSignal, currentGeoPos);
 
 }
 
 const GeodeticPosition* CircularOrbitMobility::getCurrentGeoPos() {
+    // moveAndUpdate() 只在仿真时间变化后调用 move()
+    if (lazy)
+        moveAndUpdate();
     return currentGeoPos;
 }
 
+bool CircularOrbitMobility::isLazy() const {
+    return par("lazy").boolValue();
+}
+
+bool CircularOrbitMobility::isTickDriven() {
+    ConstellationManager *manager = getConstellationManager();
+    return !isLazy() && manager != nullptr && manager->isTicking();
+}
+
+ConstellationManager *CircularOrbitMobility::getConstellationManager() {
+    if (constellation.get() == nullptr)
+        return findModuleFromPar<ConstellationManager>(par("constellationModule"), this);
+    return constellation.get();
+}
+
+void CircularOrbitMobility::updatePosition() {
+    Enter_Method_Silent();
+    moveAndUpdate();
+}
+
 }
 
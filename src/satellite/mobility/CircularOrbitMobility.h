@@ -17,6 +17,8 @@
 #define SATELLITE_CIRCULARORBITMOBILITY_H_
 
 #include "../common/TypeDefs.h"
+#include "ConstellationManager.h"
+#include "inet/common/ModuleRefByPar.h"
 #include "inet/mobility/base/MovingMobilityBase.h"
 
 
@@ -44,6 +46,15 @@ class CircularOrbitMobility : public MovingMobilityBase {
         
         GeodeticPosition *currentGeoPos;
 
+        // 网络级星座位置服务，存在时位置由其批量计算，本模块只读取自己的下标
+        ModuleRefByPar<ConstellationManager> constellation;
+        int constellationIndex = -1;
+
+        // 惰性模式：没有周期性计时器，位置在被查询时计算
+        bool lazy = false;
+        // 节拍模式：没有自己的计时器，由星座位置服务的节拍批量推进，不逐颗发射位置信号
+        bool tickDriven = false;
+
   	protected:
 		virtual void initialize(int) override;
         virtual void setInitialPosition() override;
@@ -54,7 +65,26 @@ class CircularOrbitMobility : public MovingMobilityBase {
         CircularOrbitMobility();
         ~CircularOrbitMobility();
         void initParamerers();
+        // 当前经纬度；惰性模式下按当前仿真时间计算，同一时刻只计算一次
         const GeodeticPosition* getCurrentGeoPos();
+        // 以下三个函数可能在本模块初始化之前被调用（如配置器在自身初始化中创建的信道），直接读取参数
+        // 是否为惰性模式
+        bool isLazy() const;
+        // 是否由星座位置服务的节拍推进
+        bool isTickDriven();
+        // 星座位置服务，不存在时为 nullptr
+        ConstellationManager *getConstellationManager();
+        // 按当前仿真时间更新位置（由星座节拍调用）
+        void updatePosition();
+
+        // 由轨道高度（km）计算角速度（rad/s）
+        static double computeAngularVelocity(double altitude);
+        // 由轨道参数计算 t 时刻的相位、经度和纬度（rad），与 move() 使用同一闭式公式
+        static void computeOrbitAngles(double initPhase, double alpha, double rightAscension, double earthRotationRate,
+                                       double omega, double t, double& phase, double& longitude, double& latitude);
+        // 由轨道参数计算 t 时刻的经纬高及直角坐标（GeodeticPosition::updateCartesian()），供位置预测使用
+        static GeodeticPosition computePosition(double initPhase, double alpha, double altitude, double rightAscension,
+                                                double earthRotationRate, double omega, double t);
 };
 
 }
@@ -0,0 +1,142 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "ConstellationManager.h"
+#include "CircularOrbitMobility.h"
+#include "../routing/RoutingSchedule.h"
+#include <algorithm>
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+Define_Module(ConstellationManager);
+
+simsignal_t ConstellationManager::constellationMovedSignal = registerSignal("constellationMoved");
+
+ConstellationManager::ConstellationManager() { }
+
+ConstellationManager::~ConstellationManager()
+{
+    cancelAndDelete(tickTimer);
+}
+
+void ConstellationManager::initialize()
+{
+    propagator.setSinglePrecision(par("singlePrecision"));
+    ephemerisSamples = par("ephemerisSamples");
+    ephemerisFile = par("ephemerisFile").stdstringValue();
+    if (ephemerisSamples < 0)
+        throw cRuntimeError("ConstellationManager: parameter ephemerisSamples must not be negative");
+
+    // 初始位置由各卫星在初始化时计算，第一个节拍在一个间隔之后
+    tickInterval = par("tickInterval");
+    if (tickInterval < SIMTIME_ZERO)
+        throw cRuntimeError("ConstellationManager: parameter tickInterval must not be negative");
+    if (tickInterval > SIMTIME_ZERO) {
+        tickTimer = new cMessage("constellationTick");
+        scheduleAfter(tickInterval, tickTimer);
+    }
+}
+
+void ConstellationManager::handleMessage(cMessage *msg)
+{
+    if (msg == tickTimer) {
+        tick();
+        scheduleAfter(tickInterval, tickTimer);
+    }
+    else
+        throw cRuntimeError("ConstellationManager: unexpected message %s", msg->getName());
+}
+
+void ConstellationManager::finish()
+{
+    cancelAndDelete(tickTimer);
+    tickTimer = nullptr;
+
+    recordScalar("satellites", propagator.getNumSatellites());
+    recordScalar("propagations", numPropagations);
+    recordScalar("ticks", numTicks);
+}
+
+bool ConstellationManager::isTicking() const
+{
+    return par("tickInterval").doubleValue() > 0;
+}
+
+void ConstellationManager::tick()
+{
+    // 一次批量计算，各卫星只读取自己的下标（惰性模式的卫星在被查询时才更新）
+    update(simTime());
+    for (CircularOrbitMobility *mobility : tickedSatellites)
+        mobility->updatePosition();
+    numTicks++;
+    emit(constellationMovedSignal, (intval_t)numTicks);
+}
+
+int ConstellationManager::registerSatellite(CircularOrbitMobility *mobility, const ConstellationPropagator::Elements& elements)
+{
+    if (!mobility->isLazy())
+        tickedSatellites.push_back(mobility);
+    return propagator.addSatellite(elements);
+}
+
+void ConstellationManager::setElements(int index, const ConstellationPropagator::Elements& elements)
+{
+    if (index < 0 || index >= propagator.getNumSatellites())
+        throw cRuntimeError("ConstellationManager: satellite index %d is out of range", index);
+    propagator.setElements(index, elements);
+}
+
+void ConstellationManager::buildEphemeris()
+{
+    std::vector<double> inclinations;
+    for (int i = 0; i < propagator.getNumSatellites(); i++)
+        inclinations.push_back(propagator.getAlpha(i));
+    std::sort(inclinations.begin(), inclinations.end());
+    inclinations.erase(std::unique(inclinations.begin(), inclinations.end()), inclinations.end());
+
+    propagator.setEphemerisTable(nullptr);
+    if (ephemerisFile.empty())
+        ephemeris.build(inclinations, ephemerisSamples);
+    else {
+        // 文件的键：采样数和全部轨道倾角
+        uint64_t key = RoutingSchedule::hash(0, &ephemerisSamples, sizeof(ephemerisSamples));
+        key = RoutingSchedule::hash(key, inclinations.data(), inclinations.size() * sizeof(double));
+        if (!ephemeris.open(ephemerisFile.c_str(), key)) {
+            EV_INFO << "ConstellationManager: sampling " << inclinations.size() << " ground track(s) into " << ephemerisFile << endl;
+            EphemerisTable::write(ephemerisFile.c_str(), key, inclinations, ephemerisSamples);
+            if (!ephemeris.open(ephemerisFile.c_str(), key))
+                throw cRuntimeError("ConstellationManager: cannot open the generated ephemeris table '%s'", ephemerisFile.c_str());
+        }
+    }
+    propagator.setEphemerisTable(&ephemeris);
+    EV_INFO << "ConstellationManager: using " << ephemeris.getNumTracks() << " ground track(s) of " << ephemerisSamples << " samples" << endl;
+}
+
+const ConstellationPropagator& ConstellationManager::update(simtime_t t)
+{
+    // 新登记的卫星的轨道倾角不在星历表中时重新生成
+    if (ephemerisSamples > 0 && !propagator.isEphemerisComplete())
+        buildEphemeris();
+    if (!propagator.isPropagated(t.dbl())) {
+        propagator.propagate(t.dbl());
+        numPropagations++;
+    }
+    return propagator;
+}
+
+} // namespace leolab
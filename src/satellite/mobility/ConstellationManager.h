@@ -0,0 +1,108 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef SATELLITE_MOBILITY_CONSTELLATIONMANAGER_H_
+#define SATELLITE_MOBILITY_CONSTELLATIONMANAGER_H_
+
+#include <omnetpp.h>
+#include "inet/common/INETDefs.h"
+#include "ConstellationPropagator.h"
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+class CircularOrbitMobility;
+
+/**
+ * 网络级星座位置服务。
+ * - 所有 CircularOrbitMobility 在初始化时把轨道参数登记到同一个 ConstellationPropagator（数组结构）
+ * - 某颗卫星在 t 时刻第一次需要位置时，一次批量计算出全部卫星在 t 时刻的位置，
+ *   同一时刻其余卫星的 move() 只读取数组，不再各自计算三角函数
+ * - 可选单精度计算（singlePrecision）：三角函数循环经 libmvec 向量化（makefrag 为传播器开启 -ffast-math），
+ *   单精度时每条 SSE2 指令处理 4 颗卫星而非 2 颗
+ * - 可选星历表（ephemerisSamples > 0）：每种轨道倾角的星下点轨迹只采样一个周期（地球自转是已知的线性项），
+ *   之后的位置由插值得到，不再计算三角函数；可写入以轨道倾角和采样数为键的内存映射文件（ephemerisFile），
+ *   同一星座的多次运行共用
+ * - 可选星座节拍（tickInterval > 0）：登记的卫星不再各自安排移动计时器，由本模块的一个自消息每隔 tickInterval
+ *   批量推进全部卫星，然后只发出一次 constellationMovedSignal；DynamicChannel 订阅该信号后读取两端的新位置，
+ *   不再逐颗卫星接收位置信号
+ * - 应在 WalkerDeltaTopologyConfigurator 之前声明，使其参数在配置器写入轨道参数前已读取
+ */
+class ConstellationManager : public cSimpleModule
+{
+  protected:
+    // ---------- 星座状态 ----------
+    ConstellationPropagator propagator; // 全部卫星的轨道参数和最近一次计算的位置
+    std::vector<CircularOrbitMobility *> tickedSatellites;  // 由节拍推进的移动性模块（不含惰性模式的卫星）
+
+    // ---------- 星座节拍 ----------
+    simtime_t tickInterval;             // 节拍间隔，0 表示各卫星使用自己的计时器
+    cMessage *tickTimer = nullptr;      // 节拍自消息
+
+    // ---------- 星历表 ----------
+    int ephemerisSamples = 0;           // 每个轨道周期的采样数，0 表示不使用星历表
+    std::string ephemerisFile;          // 星历表文件路径，空表示只保存在内存中
+    EphemerisTable ephemeris;           // 覆盖全部轨道倾角的星历表
+
+    // ---------- 统计 ----------
+    int numPropagations = 0;            // 批量计算的次数
+    int numTicks = 0;                   // 节拍次数
+
+  protected:
+    // OMNeT++ 生命周期
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+
+    // 为已登记卫星的全部轨道倾角打开或生成星历表
+    virtual void buildEphemeris();
+
+    // 批量推进全部卫星并发出一次 constellationMovedSignal
+    virtual void tick();
+
+  public:
+    // 每个节拍推进全部卫星后发出的信号，值为节拍序号
+    static simsignal_t constellationMovedSignal;
+
+  public:
+    ConstellationManager();
+    virtual ~ConstellationManager();
+
+    /**
+     * 登记一颗卫星的移动性模块和轨道参数，返回其在星座数组中的下标。
+     */
+    int registerSatellite(CircularOrbitMobility *mobility, const ConstellationPropagator::Elements& elements);
+
+    /**
+     * 更新已登记卫星的轨道参数（配置器在初始化时会改写轨道参数）。
+     */
+    void setElements(int index, const ConstellationPropagator::Elements& elements);
+
+    /**
+     * 返回全部卫星在 t 时刻的位置，同一时刻只计算一次。
+     */
+    const ConstellationPropagator& update(simtime_t t);
+
+    /**
+     * 是否由本模块的节拍推进卫星（可能在本模块初始化之前被调用，直接读取参数）。
+     */
+    bool isTicking() const;
+};
+
+} // namespace leolab
+
+#endif /* SATELLITE_MOBILITY_CONSTELLATIONMANAGER_H_ */
@@ -0,0 +1,202 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "ConstellationPropagator.h"
+#include <cmath>
+#include "../common/Constants.h"
+
+namespace leolab {
+
+/**
+ * Phase of n satellites at time t, reduced to [0, 2*pi) in double precision.
+ */
+static void computePhase(int n, double t, const double *__restrict initPhase, const double *__restrict omega, double *__restrict phase)
+{
+    const double twoPi = 2 * M_PI;
+    for (int i = 0; i < n; i++) {
+        double p = initPhase[i] + omega[i] * t;
+        phase[i] = p - twoPi * std::floor(p / twoPi);
+    }
+}
+
+/**
+ * Latitude, longitude relative to the ascending node and unit position vector
+ * in the frame of the ascending node of n satellites. Instantiated for double
+ * and float. Every loop calls at most one kind of math function: GCC fuses a
+ * sin() and a cos() of the same argument into sincos(), which has no vector
+ * variant, so the sine and the cosine of the phase are taken in loops of their
+ * own.
+ */
+template <typename Real>
+static void computeAngles(int n, const double *__restrict phase, const Real *__restrict sinAlpha, const Real *__restrict cosAlpha,
+                          Real *__restrict latitude, Real *__restrict longitudeOffset, Real *__restrict u, Real *__restrict v, Real *__restrict w)
+{
+    for (int i = 0; i < n; i++)
+        u[i] = std::cos((Real)phase[i]);
+    for (int i = 0; i < n; i++)
+        w[i] = std::sin((Real)phase[i]);
+    for (int i = 0; i < n; i++) {
+        v[i] = cosAlpha[i] * w[i];
+        w[i] = sinAlpha[i] * w[i];
+    }
+    for (int i = 0; i < n; i++)
+        latitude[i] = std::asin(w[i]);
+    for (int i = 0; i < n; i++)
+        longitudeOffset[i] = std::atan2(v[i], u[i]);
+}
+
+/**
+ * ECEF coordinates of n satellites: the unit position vector rotated by the
+ * longitude of the ascending node and scaled to the orbit radius.
+ */
+static void computeCartesian(int n, const double *__restrict altitude, const double *__restrict u, const double *__restrict v, const double *__restrict w,
+                             const double *__restrict sinNode, const double *__restrict cosNode, double *__restrict x, double *__restrict y, double *__restrict z)
+{
+    for (int i = 0; i < n; i++) {
+        double r = (EARTH_RADIUS_KM + altitude[i]) * 1000.0;
+        x[i] = r * (u[i] * cosNode[i] - v[i] * sinNode[i]);
+        y[i] = r * (u[i] * sinNode[i] + v[i] * cosNode[i]);
+        z[i] = r * w[i];
+    }
+}
+
+int ConstellationPropagator::addSatellite(const Elements& elements)
+{
+    int index = getNumSatellites();
+    int n = index + 1;
+    initPhase.resize(n);
+    alpha.resize(n);
+    omega.resize(n);
+    sinAlpha.resize(n);
+    cosAlpha.resize(n);
+    sinAlphaF.resize(n);
+    cosAlphaF.resize(n);
+    rightAscension.resize(n);
+    sinRightAscension.resize(n);
+    cosRightAscension.resize(n);
+    earthRotationRate.resize(n);
+    altitude.resize(n);
+    phase.resize(n);
+    longitude.resize(n);
+    latitude.resize(n);
+    x.resize(n);
+    y.resize(n);
+    z.resize(n);
+    u.resize(n);
+    v.resize(n);
+    w.resize(n);
+    sinNode.resize(n);
+    cosNode.resize(n);
+    longitudeF.resize(n);
+    latitudeF.resize(n);
+    uF.resize(n);
+    vF.resize(n);
+    wF.resize(n);
+    track.resize(n, -1);
+    numMissingTracks++;
+    setElements(index, elements);
+    return index;
+}
+
+void ConstellationPropagator::setElements(int index, const Elements& elements)
+{
+    initPhase[index] = elements.initPhase;
+    alpha[index] = elements.alpha;
+    omega[index] = elements.omega;
+    sinAlpha[index] = std::sin(elements.alpha);
+    cosAlpha[index] = std::cos(elements.alpha);
+    sinAlphaF[index] = (float)sinAlpha[index];
+    cosAlphaF[index] = (float)cosAlpha[index];
+    rightAscension[index] = elements.rightAscension;
+    sinRightAscension[index] = std::sin(elements.rightAscension);
+    cosRightAscension[index] = std::cos(elements.rightAscension);
+    earthRotationRate[index] = elements.earthRotationRate;
+    altitude[index] = elements.altitude;
+    if (track[index] == -1)
+        numMissingTracks--;
+    track[index] = ephemeris != nullptr ? ephemeris->findTrack(elements.alpha) : -1;
+    if (track[index] == -1)
+        numMissingTracks++;
+    valid = false;
+}
+
+void ConstellationPropagator::setEphemerisTable(const EphemerisTable *table)
+{
+    ephemeris = table;
+    numMissingTracks = 0;
+    for (int i = 0; i < getNumSatellites(); i++) {
+        track[i] = table != nullptr ? table->findTrack(alpha[i]) : -1;
+        if (track[i] == -1)
+            numMissingTracks++;
+    }
+    valid = false;
+}
+
+void ConstellationPropagator::propagate(double t)
+{
+    int n = getNumSatellites();
+
+    computePhase(n, t, initPhase.data(), omega.data(), phase.data());
+
+    // latitude, offset from the ascending node and unit vector; the longitude array temporarily holds the offset
+    if (isEphemerisComplete()) {
+        for (int i = 0; i < n; i++)
+            ephemeris->interpolate(track[i], phase[i], latitude[i], longitude[i], u[i], v[i], w[i]);
+    }
+    else if (singlePrecision) {
+        computeAngles<float>(n, phase.data(), sinAlphaF.data(), cosAlphaF.data(), latitudeF.data(), longitudeF.data(), uF.data(), vF.data(), wF.data());
+        for (int i = 0; i < n; i++) {
+            latitude[i] = latitudeF[i];
+            longitude[i] = longitudeF[i];
+            u[i] = uF[i];
+            v[i] = vF[i];
+            w[i] = wF[i];
+        }
+    }
+    else
+        computeAngles<double>(n, phase.data(), sinAlpha.data(), cosAlpha.data(), latitude.data(), longitude.data(), u.data(), v.data(), w.data());
+
+    // the ascending node drifts westwards with the Earth rotation
+    for (int i = 0; i < n; i++)
+        longitude[i] += rightAscension[i] - earthRotationRate[i] * t;
+
+    // sine and cosine of the longitude of the ascending node; with a common Earth rotation
+    // rate they follow from those of the right ascension by angle addition, without
+    // trigonometry per satellite
+    bool commonRotation = true;
+    for (int i = 1; i < n && commonRotation; i++)
+        commonRotation = earthRotationRate[i] == earthRotationRate[0];
+    if (commonRotation) {
+        double sinRotation = n > 0 ? std::sin(earthRotationRate[0] * t) : 0;
+        double cosRotation = n > 0 ? std::cos(earthRotationRate[0] * t) : 1;
+        for (int i = 0; i < n; i++) {
+            sinNode[i] = sinRightAscension[i] * cosRotation - cosRightAscension[i] * sinRotation;
+            cosNode[i] = cosRightAscension[i] * cosRotation + sinRightAscension[i] * sinRotation;
+        }
+    }
+    else {
+        for (int i = 0; i < n; i++)
+            sinNode[i] = std::sin(rightAscension[i] - earthRotationRate[i] * t);
+        for (int i = 0; i < n; i++)
+            cosNode[i] = std::cos(rightAscension[i] - earthRotationRate[i] * t);
+    }
+
+    computeCartesian(n, altitude.data(), u.data(), v.data(), w.data(), sinNode.data(), cosNode.data(), x.data(), y.data(), z.data());
+
+    time = t;
+    valid = true;
+}
+
+} // namespace leolab
@@ -0,0 +1,149 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef SATELLITE_MOBILITY_CONSTELLATIONPROPAGATOR_H_
+#define SATELLITE_MOBILITY_CONSTELLATIONPROPAGATOR_H_
+
+#include <vector>
+#include "EphemerisTable.h"
+
+namespace leolab {
+
+/**
+ * Batch propagator of a constellation of circular orbits.
+ *
+ * The orbital elements of all satellites are kept in structure-of-arrays
+ * form, and propagate() computes the positions of every satellite at a given
+ * time in a few straight loops over these arrays. Each loop is branch-free and
+ * calls at most one math function, so GCC vectorizes them with the vector
+ * variants of glibc's libmvec; src/makefrag compiles this file with
+ * -ffast-math, which is needed for glibc to declare those variants. For the
+ * same reason the file includes only the standard library and Constants.h:
+ * inline OMNeT++ or INET functions compiled here with finite math could be
+ * the copy the linker keeps. The angular velocity is therefore computed by
+ * the caller and passed in the elements. In single
+ * precision mode the trigonometry runs on floats, 4 instead of 2 lanes per
+ * SSE2 vector; the phase is reduced to [0, 2*pi) in double precision first, so
+ * the error stays at float epsilon even for long simulations. The floor() of
+ * that reduction only vectorizes with SSE4.1 (e.g. -march=x86-64-v2), and the
+ * ephemeris interpolation stays scalar.
+ *
+ * With an ephemeris table covering the inclinations of all satellites, the
+ * latitude and the longitude relative to the ascending node are interpolated
+ * from the table instead, and propagation needs no trigonometry at all.
+ *
+ * Besides latitude and longitude, every propagation yields the Earth-fixed
+ * Cartesian (ECEF) coordinates, from the unit position vector in the frame of
+ * the ascending node rotated about the Earth axis.
+ *
+ * The formulas are those of CircularOrbitMobility::computeOrbitAngles(). The
+ * longitude is computed with atan2() instead of a quadrant test, so it may
+ * differ from that function by a multiple of 2*pi.
+ */
+class ConstellationPropagator
+{
+  public:
+    struct Elements {
+        double initPhase = 0;           // phase at t = 0 (rad)
+        double alpha = 0;               // inclination (rad)
+        double altitude = 0;            // altitude (km)
+        double omega = 0;               // angular velocity (rad/s), from CircularOrbitMobility::computeAngularVelocity()
+        double rightAscension = 0;      // right ascension of the ascending node (rad)
+        double earthRotationRate = 0;   // rad/s
+    };
+
+  protected:
+    bool singlePrecision = false;
+
+    // orbital elements, one entry per satellite
+    std::vector<double> initPhase;
+    std::vector<double> alpha;              // inclination (rad)
+    std::vector<double> omega;              // angular velocity (rad/s)
+    std::vector<double> sinAlpha, cosAlpha;
+    std::vector<float> sinAlphaF, cosAlphaF;
+    std::vector<double> rightAscension;
+    std::vector<double> sinRightAscension, cosRightAscension;
+    std::vector<double> earthRotationRate;
+    std::vector<double> altitude;
+
+    // ephemeris table and the track of each satellite (-1: inclination not in the table)
+    const EphemerisTable *ephemeris = nullptr;
+    std::vector<int> track;
+    int numMissingTracks = 0;
+
+    // state at the last propagation time
+    double time = 0;
+    bool valid = false;
+    std::vector<double> phase;              // reduced to [0, 2*pi)
+    std::vector<double> longitude;          // rad
+    std::vector<double> latitude;           // rad
+    std::vector<double> x, y, z;            // ECEF coordinates (m)
+    std::vector<double> u, v, w;            // scratch: unit position vector in the frame of the ascending node
+    std::vector<double> sinNode, cosNode;   // scratch: sine and cosine of the longitude of the ascending node
+    std::vector<float> longitudeF, latitudeF, uF, vF, wF;   // scratch arrays of the single precision mode
+
+  public:
+    ConstellationPropagator() { }
+
+    /**
+     * Adds a satellite and returns its index.
+     */
+    int addSatellite(const Elements& elements);
+
+    /**
+     * Replaces the orbital elements of a satellite.
+     */
+    void setElements(int index, const Elements& elements);
+
+    int getNumSatellites() const { return initPhase.size(); }
+
+    void setSinglePrecision(bool singlePrecision) { this->singlePrecision = singlePrecision; valid = false; }
+    bool isSinglePrecision() const { return singlePrecision; }
+
+    /**
+     * Uses the given ephemeris table (or none) for the following propagations.
+     * The table is only used while it covers every satellite.
+     */
+    void setEphemerisTable(const EphemerisTable *table);
+
+    /**
+     * Returns true if an ephemeris table covering every satellite is set.
+     */
+    bool isEphemerisComplete() const { return ephemeris != nullptr && numMissingTracks == 0; }
+
+    /**
+     * Computes the positions of all satellites at time t (in seconds).
+     */
+    void propagate(double t);
+
+    /**
+     * Returns true if the positions of time t are available.
+     */
+    bool isPropagated(double t) const { return valid && time == t; }
+
+    double getTime() const { return time; }
+    double getAlpha(int index) const { return alpha[index]; }
+    double getPhase(int index) const { return phase[index]; }
+    double getLongitude(int index) const { return longitude[index]; }
+    double getLatitude(int index) const { return latitude[index]; }
+    double getAltitude(int index) const { return altitude[index]; }
+    double getX(int index) const { return x[index]; }
+    double getY(int index) const { return y[index]; }
+    double getZ(int index) const { return z[index]; }
+};
+
+} // namespace leolab
+
+#endif /* SATELLITE_MOBILITY_CONSTELLATIONPROPAGATOR_H_ */
@@ -0,0 +1,160 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "EphemerisTable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <omnetpp.h>
+
+namespace leolab {
+
+using namespace omnetpp;
+
+static const char MAGIC[8] = { 'L', 'E', 'O', 'E', 'P', 'H', 'E', 'M' };
+static const uint32_t VERSION = 2;
+
+void EphemerisTable::sampleTrack(double alpha, int numSamples, double *track)
+{
+    double sinAlpha = sin(alpha), cosAlpha = cos(alpha);
+    double previous = 0;
+    for (int k = 0; k <= numSamples; k++) {
+        double phase = 2 * M_PI * k / numSamples;
+        double offset = atan2(cosAlpha * sin(phase), cos(phase));
+        // unwrap: keep the offset within pi of the previous sample
+        offset += 2 * M_PI * std::round((previous - offset) / (2 * M_PI));
+        double *sample = track + (size_t)k * SAMPLE_SIZE;
+        sample[0] = asin(sinAlpha * sin(phase));
+        sample[1] = offset;
+        sample[2] = cos(phase);
+        sample[3] = cosAlpha * sin(phase);
+        sample[4] = sinAlpha * sin(phase);
+        previous = offset;
+    }
+}
+
+void EphemerisTable::build(const std::vector<double>& inclinations, int numSamples)
+{
+    if (inclinations.empty() || numSamples <= 0)
+        throw cRuntimeError("EphemerisTable: invalid dimensions (%d tracks, %d samples)", (int)inclinations.size(), numSamples);
+    close();
+    size_t trackSize = (size_t)(numSamples + 1) * SAMPLE_SIZE;
+    storage.resize(inclinations.size() * (1 + trackSize));
+    std::copy(inclinations.begin(), inclinations.end(), storage.begin());
+    for (size_t t = 0; t < inclinations.size(); t++)
+        sampleTrack(inclinations[t], numSamples, storage.data() + inclinations.size() + t * trackSize);
+    this->numTracks = inclinations.size();
+    this->numSamples = numSamples;
+    this->inclinations = storage.data();
+    this->samples = storage.data() + inclinations.size();
+}
+
+void EphemerisTable::write(const char *filename, uint64_t key, const std::vector<double>& inclinations, int numSamples)
+{
+    EphemerisTable table;
+    table.build(inclinations, numSamples);
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.numTracks = table.numTracks;
+    header.numSamples = numSamples;
+    header.key = key;
+
+    std::string tmpFilename = std::string(filename) + ".tmp";
+    FILE *f = fopen(tmpFilename.c_str(), "wb");
+    if (!f)
+        throw cRuntimeError("EphemerisTable: cannot create '%s'", tmpFilename.c_str());
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    ok = ok && fwrite(table.storage.data(), sizeof(double), table.storage.size(), f) == table.storage.size();
+    ok = fclose(f) == 0 && ok;
+    if (!ok || rename(tmpFilename.c_str(), filename) != 0) {
+        remove(tmpFilename.c_str());
+        throw cRuntimeError("EphemerisTable: cannot write '%s'", filename);
+    }
+}
+
+bool EphemerisTable::open(const char *filename, uint64_t key)
+{
+    close();
+
+    int fd = ::open(filename, O_RDONLY);
+    if (fd == -1)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header)) {
+        ::close(fd);
+        throw cRuntimeError("EphemerisTable: '%s' is not an ephemeris table", filename);
+    }
+    void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);   // the mapping keeps the file open
+    if (mapped == MAP_FAILED)
+        throw cRuntimeError("EphemerisTable: cannot map '%s'", filename);
+
+    const Header *h = static_cast<const Header *>(mapped);
+    if (memcmp(h->magic, MAGIC, sizeof(MAGIC)) == 0 && h->version != VERSION) {
+        // written by another version of this class: regenerate
+        munmap(mapped, st.st_size);
+        return false;
+    }
+    if (memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 || h->numTracks <= 0 || h->numSamples <= 0
+            || (size_t)st.st_size != sizeof(Header) + (size_t)h->numTracks * (1 + (size_t)(h->numSamples + 1) * SAMPLE_SIZE) * sizeof(double)) {
+        munmap(mapped, st.st_size);
+        throw cRuntimeError("EphemerisTable: '%s' is not an ephemeris table or is truncated", filename);
+    }
+    if (h->key != key) {
+        munmap(mapped, st.st_size);
+        return false;
+    }
+
+    data = mapped;
+    size = st.st_size;
+    numTracks = h->numTracks;
+    numSamples = h->numSamples;
+    inclinations = reinterpret_cast<const double *>(h + 1);
+    samples = inclinations + numTracks;
+    return true;
+}
+
+void EphemerisTable::close()
+{
+    if (data != nullptr)
+        munmap(data, size);
+    data = nullptr;
+    size = 0;
+    storage.clear();
+    numTracks = 0;
+    numSamples = 0;
+    inclinations = nullptr;
+    samples = nullptr;
+}
+
+int EphemerisTable::findTrack(double alpha) const
+{
+    for (int t = 0; t < numTracks; t++)
+        if (inclinations[t] == alpha)
+            return t;
+    return -1;
+}
+
+} // namespace leolab
@@ -0,0 +1,141 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef SATELLITE_MOBILITY_EPHEMERISTABLE_H_
+#define SATELLITE_MOBILITY_EPHEMERISTABLE_H_
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace leolab {
+
+/**
+ * Sampled ground tracks of circular orbits, answering position queries by
+ * linear interpolation instead of trigonometry.
+ *
+ * On a circular orbit, the latitude and the longitude relative to the
+ * ascending node depend only on the inclination and the phase:
+ *
+ *   latitude        = asin(sin(alpha) * sin(phase))
+ *   longitudeOffset = atan2(cos(alpha) * sin(phase), cos(phase))
+ *
+ * The ascending node itself moves linearly with the Earth rotation. A track
+ * therefore samples one orbital period of these two functions, and all
+ * satellites of the same inclination (e.g. a whole Walker constellation) share
+ * it. longitudeOffset is unwrapped to be continuous over the period. A track
+ * also samples the unit position vector in the frame of the ascending node,
+ *
+ *   (cos(phase), cos(alpha) * sin(phase), sin(alpha) * sin(phase)),
+ *
+ * so that Cartesian coordinates need only a rotation about the Earth axis.
+ *
+ * The table lives either in memory or in a memory-mapped file whose header
+ * records a key identifying the inputs, like RoutingSchedule. Near-polar
+ * orbits turn sharply at the poles and need more samples for the same
+ * accuracy.
+ */
+class EphemerisTable
+{
+  protected:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        int32_t numTracks;
+        int32_t numSamples;
+        int32_t reserved;
+        uint64_t key;
+    };
+
+    void *data = nullptr;               // the mapped file, if any
+    size_t size = 0;
+    std::vector<double> storage;        // the table when built in memory
+    int numTracks = 0;
+    int numSamples = 0;                 // samples per period; every track has numSamples + 1 points
+    const double *inclinations = nullptr;   // numTracks
+    const double *samples = nullptr;    // numTracks x (numSamples + 1) x SAMPLE_SIZE
+
+  public:
+    // values per sample: latitude, longitudeOffset and the unit vector u, v, w
+    static const int SAMPLE_SIZE = 5;
+
+  protected:
+    // fills (numSamples + 1) x SAMPLE_SIZE values of the given inclination
+    static void sampleTrack(double alpha, int numSamples, double *track);
+
+  public:
+    EphemerisTable() { }
+    ~EphemerisTable() { close(); }
+
+    EphemerisTable(const EphemerisTable&) = delete;
+    EphemerisTable& operator=(const EphemerisTable&) = delete;
+
+    /**
+     * Samples the tracks of the given inclinations (rad) in memory.
+     */
+    void build(const std::vector<double>& inclinations, int numSamples);
+
+    /**
+     * Samples the tracks of the given inclinations and writes them to the
+     * given file, under a temporary name renamed at the end.
+     */
+    static void write(const char *filename, uint64_t key, const std::vector<double>& inclinations, int numSamples);
+
+    /**
+     * Maps the given file. Returns false if the file does not exist or was
+     * written for a different key or format version; throws if it exists but
+     * is malformed.
+     */
+    bool open(const char *filename, uint64_t key);
+
+    /**
+     * Releases the table (unmaps the file).
+     */
+    void close();
+
+    bool isEmpty() const { return samples == nullptr; }
+    int getNumTracks() const { return numTracks; }
+    int getNumSamples() const { return numSamples; }
+
+    /**
+     * Returns the track of the given inclination, or -1 if there is none.
+     */
+    int findTrack(double alpha) const;
+
+    /**
+     * Interpolates the latitude and the longitude relative to the ascending
+     * node (rad), and the unit position vector in the frame of the ascending
+     * node, at the given phase, which must be in [0, 2*pi).
+     */
+    void interpolate(int track, double phase, double& latitude, double& longitudeOffset, double& u, double& v, double& w) const {
+        double x = phase * (numSamples / (2 * M_PI));
+        int i = (int)x;
+        if (i >= numSamples)
+            i = numSamples - 1;
+        double f = x - i;
+        const double *p = samples + ((size_t)track * (numSamples + 1) + i) * SAMPLE_SIZE;
+        const double *q = p + SAMPLE_SIZE;
+        latitude = p[0] + f * (q[0] - p[0]);
+        longitudeOffset = p[1] + f * (q[1] - p[1]);
+        u = p[2] + f * (q[2] - p[2]);
+        v = p[3] + f * (q[3] - p[3]);
+        w = p[4] + f * (q[4] - p[4]);
+    }
+};
+
+} // namespace leolab
+
+#endif /* SATELLITE_MOBILITY_EPHEMERISTABLE_H_ */
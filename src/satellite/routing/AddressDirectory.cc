@@ -0,0 +1,194 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "AddressDirectory.h"
+
+#include <algorithm>
+
+#include "inet/common/ModuleAccess.h"
+#include "inet/common/Simsignals.h"
+#include "inet/networklayer/ipv4/Ipv4InterfaceData.h"
+#include "inet/networklayer/contract/IInterfaceTable.h"
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+Define_Module(AddressDirectory);
+
+simsignal_t AddressDirectory::directoryChangedSignal = registerSignal("addressDirectoryChanged");
+
+AddressDirectory::AddressDirectory() { }
+
+AddressDirectory::~AddressDirectory() { }
+
+void AddressDirectory::initialize()
+{
+    network = getParentModule();
+    satelliteModuleName = par("satelliteModuleName").stdstringValue();
+    interfaceName = par("interfaceName").stdstringValue();
+    if (!network->hasSubmoduleVector(satelliteModuleName.c_str()))
+        throw cRuntimeError("AddressDirectory: %s has no submodule vector '%s'", network->getFullPath().c_str(), satelliteModuleName.c_str());
+    entries.resize(network->getSubmoduleVectorSize(satelliteModuleName.c_str()));
+
+    // 接口配置变化信号会沿模块树向上传播，在网络顶层模块上统一订阅
+    cModule *systemModule = getSimulation()->getSystemModule();
+    systemModule->subscribe(interfaceConfigChangedSignal, this);
+    systemModule->subscribe(interfaceIpv4ConfigChangedSignal, this);
+    systemModule->subscribe(interfaceDeletedSignal, this);
+}
+
+void AddressDirectory::handleMessage(cMessage *msg)
+{
+    throw cRuntimeError("AddressDirectory: this module does not process messages");
+}
+
+void AddressDirectory::finish()
+{
+    EV_INFO << "AddressDirectory: " << numResolutions << " entry resolution(s), " << numInvalidations
+            << " invalidation(s) for " << entries.size() << " satellites" << endl;
+
+    // 仿真结束后网络拆除时的接口删除无需处理
+    cModule *systemModule = getSimulation()->getSystemModule();
+    systemModule->unsubscribe(interfaceConfigChangedSignal, this);
+    systemModule->unsubscribe(interfaceIpv4ConfigChangedSignal, this);
+    systemModule->unsubscribe(interfaceDeletedSignal, this);
+}
+
+const AddressDirectory::Entry& AddressDirectory::getEntry(int index)
+{
+    if (index < 0 || index >= (int)entries.size())
+        throw cRuntimeError("AddressDirectory: satellite index %d out of range 0..%d", index, (int)entries.size() - 1);
+    if (!entries[index].valid)
+        resolve(index);
+    return entries[index];
+}
+
+const AddressDirectory::Entry *AddressDirectory::findEntry(cModule *node)
+{
+    int index = findIndex(node);
+    return index == -1 ? nullptr : &getEntry(index);
+}
+
+int AddressDirectory::findIndex(cModule *node) const
+{
+    if (node == nullptr || node->getParentModule() != network || !node->isVector() || satelliteModuleName != node->getName())
+        return -1;
+    return node->getIndex();
+}
+
+int AddressDirectory::findIndex(const Ipv4Address& address, int *prefixLength) const
+{
+    for (const Ipv4Address& netmask : netmasks) {
+        auto it = networkIndices.find(address.doAnd(netmask).getInt());
+        if (it != networkIndices.end()) {
+            if (prefixLength)
+                *prefixLength = netmask.getNetmaskLength();
+            return it->second;
+        }
+    }
+    return -1;
+}
+
+void AddressDirectory::updateLookup()
+{
+    if (lookupVersion != version)
+        rebuildLookup();
+}
+
+void AddressDirectory::rebuildLookup()
+{
+    // 接口正在重新配置时（如地址已清除、新地址尚未写入）条目可能暂时无法解析或子网重复，
+    // 跳过这些条目，配置完成时的变化通知会再次重建
+    networkIndices.clear();
+    netmasks.clear();
+    for (int i = 0; i < (int)entries.size(); i++) {
+        if (!entries[i].valid && !tryResolve(i))
+            continue;
+        const Entry& entry = entries[i];
+        auto result = networkIndices.insert(std::make_pair(entry.network.getInt(), i));
+        if (!result.second) {
+            EV_WARN << "AddressDirectory: satellites " << result.first->second << " and " << i << " have the same " << interfaceName
+                    << " subnet " << entry.network << ", ignoring satellite " << i << endl;
+            continue;
+        }
+        if (std::find(netmasks.begin(), netmasks.end(), entry.netmask) == netmasks.end())
+            netmasks.push_back(entry.netmask);
+    }
+    std::sort(netmasks.begin(), netmasks.end(), [] (const Ipv4Address& a, const Ipv4Address& b) { return a.getNetmaskLength() > b.getNetmaskLength(); });
+    lookupVersion = version;
+}
+
+void AddressDirectory::resolve(int index)
+{
+    if (!tryResolve(index)) {
+        cModule *node = network->getSubmodule(satelliteModuleName.c_str(), index);
+        throw cRuntimeError("AddressDirectory: %s has no %s interface or the interface has no IP address", node->getFullPath().c_str(), interfaceName.c_str());
+    }
+}
+
+bool AddressDirectory::tryResolve(int index)
+{
+    cModule *node = network->getSubmodule(satelliteModuleName.c_str(), index);
+    IInterfaceTable *ifTable = check_and_cast<IInterfaceTable *>(node->getSubmodule("interfaceTable"));
+    NetworkInterface *networkInterface = ifTable->findInterfaceByName(interfaceName.c_str());
+    if (!networkInterface || networkInterface->getIpv4Address().isUnspecified())
+        return false;
+
+    Entry& entry = entries[index];
+    entry.networkInterface = networkInterface;
+    entry.address = networkInterface->getIpv4Address();
+    entry.netmask = networkInterface->getIpv4Netmask();
+    entry.network = entry.address.doAnd(entry.netmask);
+    entry.valid = true;
+    numResolutions++;
+    return true;
+}
+
+void AddressDirectory::receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj, cObject *details)
+{
+    Enter_Method("%s", cComponent::getSignalName(signalID));
+
+    // 接口删除时 obj 为接口本身，配置变化时为 NetworkInterfaceChangeDetails；
+    // 只关心地址和子网掩码：IPv4 配置的增删，以及其中地址或掩码字段的修改
+    NetworkInterface *networkInterface = dynamic_cast<NetworkInterface *>(obj);
+    if (auto changeDetails = dynamic_cast<NetworkInterfaceChangeDetails *>(obj)) {
+        int fieldId = changeDetails->getFieldId();
+        if (signalID == interfaceConfigChangedSignal && fieldId != NetworkInterface::F_IPV4_DATA)
+            return;
+        if (signalID == interfaceIpv4ConfigChangedSignal && fieldId != Ipv4InterfaceData::F_IP_ADDRESS && fieldId != Ipv4InterfaceData::F_NETMASK)
+            return;
+        networkInterface = changeDetails->getNetworkInterface();
+    }
+    if (networkInterface == nullptr || interfaceName != networkInterface->getInterfaceName())
+        return;
+
+    // 查找表建立之前只作废对应卫星已解析的条目，未解析的条目在查询时自然读取新配置；
+    // 建立之后立即重建，转发路径上的查找不必检查版本
+    int index = findIndex(findContainingNode(networkInterface));
+    bool lookupBuilt = lookupVersion != -1;
+    if (index != -1 && (entries[index].valid || lookupBuilt)) {
+        entries[index].valid = false;
+        version++;
+        numInvalidations++;
+        EV_DETAIL << "AddressDirectory: " << networkInterface->getFullPath() << " changed, entry " << index << " invalidated" << endl;
+        if (lookupBuilt)
+            rebuildLookup();
+        emit(directoryChangedSignal, (intval_t)version);
+    }
+}
+
+} // namespace leolab
@@ -0,0 +1,133 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef SATELLITE_ROUTING_ADDRESSDIRECTORY_H_
+#define SATELLITE_ROUTING_ADDRESSDIRECTORY_H_
+
+#include <unordered_map>
+#include <vector>
+#include <omnetpp.h>
+#include "inet/common/INETDefs.h"
+#include "inet/networklayer/common/NetworkInterface.h"
+#include "inet/networklayer/contract/ipv4/Ipv4Address.h"
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+/**
+ * 网络级的卫星接口/地址目录。
+ * - 按卫星在模块向量中的下标保存其 eth4（interfaceName）接口的地址、子网掩码和 NetworkInterface*，
+ *   各路由模块查找目的子网时不必再逐个访问目的节点的接口表
+ * - 每个条目在第一次查询时解析，之后一直复用
+ * - 监听 INET 的接口配置变化信号，只在 eth4 的地址或子网掩码变化（如 DHCP 服务器重新配置接口）
+ *   或接口被删除时作废对应卫星的条目，下一次查询时重新解析；每次作废都递增版本号并发出 directoryChanged 信号
+ * - 反向查找：由任意地址得到其所在 eth4 子网的卫星下标（地面主机经 DHCP 取得所接入卫星子网内的地址），
+ *   按子网掩码长度分组的哈希表，每次查找 O(掩码种类数)，通常为 O(1)；
+ *   查找表在 updateLookup() 时建立，之后每次作废条目时立即重建，转发路径上的查找只读、不会报错
+ */
+class AddressDirectory : public cSimpleModule, public cListener
+{
+  public:
+    // 一个卫星的 eth4 接口
+    struct Entry {
+        NetworkInterface *networkInterface = nullptr;   // 接口
+        Ipv4Address address;        // 接口地址
+        Ipv4Address netmask;        // 子网掩码
+        Ipv4Address network;        // 子网地址（address & netmask）
+        bool valid = false;         // 是否已解析且未作废
+    };
+
+  private:
+    // ---------- 目录 ----------
+    cModule *network = nullptr;         // 卫星所在的网络模块
+    std::string satelliteModuleName;    // 卫星模块向量的名字
+    std::string interfaceName;          // 目录中记录的接口名
+    std::vector<Entry> entries;         // 按卫星下标索引
+    int version = 0;                    // 条目作废时递增的版本号
+
+    // ---------- 反向查找 ----------
+    std::unordered_map<uint32_t, int> networkIndices;   // 子网地址 -> 卫星下标
+    std::vector<Ipv4Address> netmasks;  // 出现过的子网掩码，由长到短
+    int lookupVersion = -1;             // 反向查找表对应的目录版本号，-1 表示尚未建立
+
+    // ---------- 统计 ----------
+    int numResolutions = 0;             // 解析条目的次数
+    int numInvalidations = 0;           // 作废条目的次数
+
+    // ---------- 私有方法 ----------
+    bool tryResolve(int index);         // 从卫星的接口表解析条目，接口不存在或未配置地址时返回 false
+    void resolve(int index);            // 同上，失败时报错
+    void rebuildLookup();               // 解析全部条目并重建反向查找表，跳过无法解析的条目
+
+  protected:
+    // OMNeT++ 生命周期
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+
+    // cListener 接口，处理接口配置变化通知
+    virtual void receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj, cObject *details) override;
+
+  public:
+    AddressDirectory();
+    virtual ~AddressDirectory();
+
+    /**
+     * 返回目录中的卫星数。
+     */
+    int getNumEntries() const { return entries.size(); }
+
+    /**
+     * 返回下标为 index 的卫星的接口条目，必要时先解析；
+     * 卫星没有该接口或接口未配置 IP 地址时报错。
+     */
+    const Entry& getEntry(int index);
+
+    /**
+     * 返回节点的接口条目，节点不属于目录（不是卫星模块向量的元素）时返回 nullptr。
+     */
+    const Entry *findEntry(cModule *node);
+
+    /**
+     * 返回节点在目录中的下标，节点不是卫星模块向量的元素时返回 -1。
+     */
+    int findIndex(cModule *node) const;
+
+    /**
+     * 返回 eth4 子网包含该地址的卫星下标（最长前缀匹配），没有或查找表尚未建立时返回 -1；
+     * prefixLength 非空时写入匹配的子网掩码长度。只读查找表，不解析条目，不会报错。
+     */
+    int findIndex(const Ipv4Address& address, int *prefixLength = nullptr) const;
+
+    /**
+     * 查找表尚未建立或不是当前版本时解析全部条目并重建。
+     */
+    void updateLookup();
+
+    /**
+     * 返回目录的版本号，有条目作废时递增。
+     */
+    int getVersion() const { return version; }
+
+  public:
+    // 有条目作废时发出的信号，值为新的版本号
+    static simsignal_t directoryChangedSignal;
+};
+
+} // namespace leolab
+
+#endif /* SATELLITE_ROUTING_ADDRESSDIRECTORY_H_ */
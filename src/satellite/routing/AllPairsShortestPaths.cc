@@ -0,0 +1,76 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "AllPairsShortestPaths.h"
+
+#include <algorithm>
+
+#include "WorkerPool.h"
+
+namespace leolab {
+
+void AllPairsShortestPaths::clear()
+{
+    numNodes = 0;
+    firstEdges.clear();
+    firstEdges.shrink_to_fit();
+    trees.clear();
+    trees.shrink_to_fit();
+}
+
+void AllPairsShortestPaths::calculate(const CsrGraph& graph, WorkerPool& pool, bool keepTrees)
+{
+    if (keepTrees != this->keepTrees || graph.getNumNodes() != numNodes)
+        clear();
+    numNodes = graph.getNumNodes();
+    this->keepTrees = keepTrees;
+
+    if (keepTrees) {
+        trees.resize(numNodes);
+        pool.parallelFor(numNodes, [&] (int source) {
+            graph.calculateShortestPathsFrom(source, trees[source]);
+        });
+        return;
+    }
+
+    // one scratch tree per chunk of sources; only the first edges are kept
+    firstEdges.resize((size_t)numNodes * numNodes);
+    int numChunks = std::min(numNodes, pool.getNumThreads() * 8);
+    pool.parallelFor(numChunks, [&] (int chunk) {
+        CsrGraph::ShortestPathTree tree;
+        int end = (int)((long long)numNodes * (chunk + 1) / numChunks);
+        for (int source = (int)((long long)numNodes * chunk / numChunks); source < end; source++) {
+            graph.calculateShortestPathsFrom(source, tree);
+            std::copy(tree.firstEdge.begin(), tree.firstEdge.end(), firstEdges.begin() + (size_t)source * numNodes);
+        }
+    });
+}
+
+int AllPairsShortestPaths::update(const CsrGraph& graph, const std::vector<int>& changedEdges, WorkerPool& pool)
+{
+    if (!keepTrees)
+        throw cRuntimeError("AllPairsShortestPaths: only the first hops are kept, recalculation needed");
+    if (graph.getNumNodes() != numNodes)
+        throw cRuntimeError("AllPairsShortestPaths: graph has changed, recalculation needed");
+
+    std::vector<uint8_t> treeChanged(numNodes, false);
+    pool.parallelFor(numNodes, [&] (int source) {
+        if (graph.updateShortestPathsFrom(trees[source], changedEdges) > 0)
+            treeChanged[source] = true;
+    });
+    return std::count(treeChanged.begin(), treeChanged.end(), true);
+}
+
+} // namespace leolab
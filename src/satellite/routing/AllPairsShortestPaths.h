@@ -0,0 +1,100 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef SATELLITE_ROUTING_ALLPAIRSSHORTESTPATHS_H_
+#define SATELLITE_ROUTING_ALLPAIRSSHORTESTPATHS_H_
+
+#include <vector>
+
+#include "CsrGraph.h"
+
+namespace leolab {
+
+class WorkerPool;
+
+/**
+ * First hops of the shortest paths between all pairs of nodes of a CsrGraph,
+ * computed with one Dijkstra search per source node.
+ *
+ * The searches are independent, so they are distributed over the threads of
+ * a WorkerPool. Every search writes only its own row, therefore the results
+ * are identical for any number of threads. The first hops are labelled by the
+ * searches themselves (see ShortestPathTree::firstEdge), so no extra pass
+ * over the trees is needed.
+ *
+ * By default only the first edge of every path is kept (an N x N table of
+ * edge indices, 4 bytes per pair). If the full trees are kept as well (dist,
+ * predEdge and firstEdge, 16 bytes per pair), they can be repaired after
+ * link changes instead of being recomputed; see update().
+ */
+class AllPairsShortestPaths
+{
+  protected:
+    int numNodes = 0;
+    bool keepTrees = false;
+    std::vector<int> firstEdges;                    // numNodes x numNodes, row per source; without trees
+    std::vector<CsrGraph::ShortestPathTree> trees;  // indexed by source node; with trees
+
+  public:
+    /**
+     * Returns the memory that the full trees take for the given number of
+     * nodes, in bytes.
+     */
+    static double getTreeMemory(int numNodes) { return (double)numNodes * numNodes * (sizeof(double) + 2 * sizeof(int)); }
+
+    /**
+     * Computes the shortest paths from all nodes of the graph. If keepTrees
+     * is true, the full trees are stored, so that update() can repair them.
+     * The graph must not be modified while the computation is running.
+     */
+    void calculate(const CsrGraph& graph, WorkerPool& pool, bool keepTrees = false);
+
+    /**
+     * Returns true if the full trees are kept, i.e. update() can be used.
+     */
+    bool hasTrees() const { return keepTrees; }
+
+    /**
+     * Repairs all trees after the weight or enabled state of the given edges
+     * has been changed in place (see CsrGraph::updateShortestPathsFrom()).
+     * Returns the number of trees that have changed. Requires the full trees.
+     */
+    int update(const CsrGraph& graph, const std::vector<int>& changedEdges, WorkerPool& pool);
+
+    /**
+     * Deletes the results.
+     */
+    void clear();
+
+    int getNumNodes() const { return numNodes; }
+
+    /**
+     * Returns the first edges of the shortest paths from source to every
+     * node (numNodes entries, -1 for the source itself and unreachable nodes).
+     */
+    const int *getFirstHopEdges(int source) const {
+        return keepTrees ? trees[source].firstEdge.data() : firstEdges.data() + (size_t)source * numNodes;
+    }
+
+    /**
+     * Returns the first edge of the shortest path from source to dest, or -1
+     * if dest is the source itself or unreachable.
+     */
+    int getFirstHopEdge(int source, int dest) const { return getFirstHopEdges(source)[dest]; }
+};
+
+} // namespace leolab
+
+#endif /* SATELLITE_ROUTING_ALLPAIRSSHORTESTPATHS_H_ */
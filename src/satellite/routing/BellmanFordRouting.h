@@ -16,11 +16,7 @@
 #ifndef SATELLITE_ROUTING_BELLMANFORDROUTING_H_
 #define SATELLITE_ROUTING_BELLMANFORDROUTING_H_
 
-#include "Topology.h"
-#include <omnetpp.h>
-#include "inet/common/INETDefs.h"
-#include "inet/networklayer/ipv4/IIpv4RoutingTable.h"
-#include "inet/networklayer/contract/IInterfaceTable.h"
+#include "IdealRoutingBase.h"
 
 namespace leolab {
 
@@ -28,43 +24,30 @@ using namespace omnetpp;
 using namespace inet;
 
 /**
- * 基于 Dijkstra（或子类自定义）算法的路由模块。
- * - 继承 cSimpleModule（OMNeT++ 模块基类）  
- * - 通过内部嵌套类 Topology 继承 inet::Topology，以便直接修改、调用`calculateWeightedSingleShortestPathsFrom` 等成员。
+ * 基于 Bellman-Ford（或子类自定义）算法的路由模块。
+ * - 继承 IdealRoutingBase（计时器、共享拓扑与路由表写入的公共逻辑）
+ * - 在共享拓扑的邻接数组（CSR）上计算本节点的单源最短路径，实现方式由 variant 参数选择
  */
-class BellmanFordRouting : public cSimpleModule
+class BellmanFordRouting : public IdealRoutingBase
 {
-  private:
-    // ---------- 计时器 ----------
-    cMessage *startupTimer = nullptr;   // 延迟启动的自触发消息
-
-    // ---------- 宿主信息 ----------
-    cModule *host = nullptr;            // 拥有本模块的节点（router / host）
-
-    ModuleRefByPar<IIpv4RoutingTable> rt;   // 宿主的 IPv4 路由表
-    ModuleRefByPar<IInterfaceTable> ift;    // 宿主的接口表
-
-    // ---------- 私有方法 ----------
-    void updateRoutingTable();          // 抽取拓扑、计算路径并写入路由表
+  protected:
+    // Bellman-Ford 的实现方式
+    enum Variant {
+        CLASSIC,    // 每轮按源节点顺序松弛全部边
+        SPFA,       // 只松弛距离变小的节点（FIFO 队列 + 入队位图）
+        SWEEP       // 按目的节点分组的结构数组逐轮扫描（标量，访存连续）
+    };
+    Variant variant = CLASSIC;
 
   protected:
-    // OMNeT++ 生命周期
-    virtual int numInitStages() const override { return NUM_INIT_STAGES; }
     virtual void initialize(int stage) override;
-    virtual void handleMessage(cMessage *msg) override;
-    virtual void finish() override;    // 释放计时器
+    // 计算本节点到每个目的节点的第一条边
+    virtual void calculateFirstHops(const CsrGraph& graph, int hostIndex, std::vector<int>& firstHopEdges) override;
+    virtual const char *getAlgorithmName() const override { return "Bellman-Ford"; }
 
   public:
     BellmanFordRouting();
     virtual ~BellmanFordRouting();
-
-    // 让外部代码能够直接使用 Topology 功能
-    class Topology : public leolab::Topology {
-    public:
-        // 直接复用 inet::Topology 的构造函数
-        explicit Topology(const char *name = nullptr) : leolab::Topology(name) {};
-        virtual void calculateWeightedSingleShortestPathsFrom(Node *source) const;
-    };
 };
 
 } // namespace leolab
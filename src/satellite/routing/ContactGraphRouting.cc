@@ -0,0 +1,112 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "ContactGraphRouting.h"
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+Define_Module(ContactGraphRouting);
+
+ContactGraphRouting::ContactGraphRouting() { }
+
+ContactGraphRouting::~ContactGraphRouting()
+{
+    cancelAndDelete(contactTimer);
+}
+
+void ContactGraphRouting::initialize(int stage)
+{
+    IdealRoutingBase::initialize(stage);
+
+    if (stage == INITSTAGE_LOCAL) {
+        contactPlan.reference(this, "contactPlanModule", true);
+        contactTimer = new cMessage("ContactGraph-contact");
+    }
+}
+
+void ContactGraphRouting::handleMessage(cMessage *msg)
+{
+    if (msg == contactTimer)
+        updateRoutingTable();
+    else
+        IdealRoutingBase::handleMessage(msg);
+}
+
+void ContactGraphRouting::finish()
+{
+    cancelAndDelete(contactTimer);
+    contactTimer = nullptr;
+    IdealRoutingBase::finish();
+}
+
+void ContactGraphRouting::updateRoutingTable()
+{
+    // 计划中编号不小于卫星数的节点为地面终端，只作为接触图的端点，不为其安装路由
+    const ContactPlan *plan = contactPlan->getContactPlan();
+    int numSatellites = contactPlan->getNumSatellites();
+    if (!host->isVector() || host->getVectorSize() != numSatellites)
+        throw cRuntimeError("ContactGraphRouting: host %s is not an element of the %d-satellite vector of the contact plan", host->getFullPath().c_str(), numSatellites);
+
+    // 从当前时刻出发的最早到达路径
+    double now = simTime().dbl();
+    std::vector<double> arrival;
+    std::vector<int> firstPorts;
+    plan->calculateEarliestArrival(host->getIndex(), now, arrival, firstPorts);
+
+    // 接触的端口即 ethg 门下标，对应接口 eth<端口>
+    std::map<int, NetworkInterface *> portInterfaces;
+    cModule *network = host->getParentModule();
+    RouteMap wantedRoutes;
+    std::set<Ipv4Address> unreachableNetworks;
+    for (int i = 0; i < numSatellites; ++i) {
+        if (i == host->getIndex()) continue;    // 跳过自己
+
+        // 取得目的节点 eth4 接口的子网
+        cModule *dstMod = network->getSubmodule(host->getName(), i);
+        Ipv4Address destNetwork, destMask;
+        findDestinationNetwork(dstMod, destNetwork, destMask);
+
+        int port = firstPorts[i];
+        if (port == -1) {
+            EV_WARN << "Destination node " << dstMod->getFullPath() << " is unreachable within the contact plan" << endl;
+            unreachableNetworks.insert(destNetwork);
+            continue;
+        }
+
+        auto it = portInterfaces.find(port);
+        if (it == portInterfaces.end()) {
+            std::string ifName = "eth" + std::to_string(port);
+            NetworkInterface *intf = ift->findInterfaceByName(ifName.c_str());
+            if (!intf)
+                throw cRuntimeError("ContactGraphRouting: %s has no interface %s", host->getFullPath().c_str(), ifName.c_str());
+            it = portInterfaces.insert(std::make_pair(port, intf)).first;
+        }
+        wantedRoutes[std::make_pair(destNetwork, destMask)] = it->second;
+    }
+
+    installRoutes(wantedRoutes, unreachableNetworks);
+
+    // 在接触图的下一个变化时刻重新计算；计划的末尾一定晚于当前时刻，到达末尾时计划随之重新生成
+    double next = plan->getNextBoundary(now);
+    while (SimTime(next) <= simTime() && next < plan->getEndTime())
+        next = plan->getNextBoundary(next);
+    if (SimTime(next) > simTime())
+        rescheduleAt(next, contactTimer);
+}
+
+} // namespace leolab
@@ -0,0 +1,56 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef SATELLITE_ROUTING_CONTACTGRAPHROUTING_H_
+#define SATELLITE_ROUTING_CONTACTGRAPHROUTING_H_
+
+#include "IdealRoutingBase.h"
+#include "ContactPlanManager.h"
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+/**
+ * 基于预测接触计划的接触图路由（contact graph routing）。
+ * - 接触计划由 ContactPlanManager 按轨道预测，包含每条星间链路和星地链路的可用区间和时延
+ * - 在接触图上计算从本节点当前时刻出发的最早到达路径，把第一跳端口写入路由表
+ * - 下一次更新安排在接触计划的下一个变化时刻（接触开始或结束，即星地切换时刻），链路断开/恢复时路由恰好同时切换，
+ *   不依赖周期更新或拓扑变化通知
+ * - 只覆盖卫星之间的路由；地面终端只作为接触图的端点
+ */
+class ContactGraphRouting : public IdealRoutingBase
+{
+  protected:
+    // ---------- 接触计划 ----------
+    ModuleRefByPar<ContactPlanManager> contactPlan;     // 网络级接触计划
+    cMessage *contactTimer = nullptr;   // 在下一个接触变化时刻更新路由的自触发消息
+
+  protected:
+    virtual void initialize(int stage) override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+    virtual void updateRoutingTable() override;
+    virtual const char *getAlgorithmName() const override { return "ContactGraph"; }
+
+  public:
+    ContactGraphRouting();
+    virtual ~ContactGraphRouting();
+};
+
+} // namespace leolab
+
+#endif /* SATELLITE_ROUTING_CONTACTGRAPHROUTING_H_ */
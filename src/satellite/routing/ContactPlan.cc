@@ -0,0 +1,119 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "ContactPlan.h"
+#include "IndexedHeap.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace leolab {
+
+void ContactPlan::clear(int numNodes, double startTime, double endTime)
+{
+    this->numNodes = numNodes;
+    this->startTime = startTime;
+    this->endTime = endTime;
+    contacts.clear();
+    nodeLinks.assign(numNodes + 1, 0);
+    linkContacts.assign(1, 0);
+    boundaries.clear();
+}
+
+void ContactPlan::addContact(const Contact& contact)
+{
+    contacts.push_back(contact);
+}
+
+void ContactPlan::finalize()
+{
+    for (const Contact& c : contacts)
+        if (c.from < 0 || c.from >= numNodes || c.to < 0 || c.to >= numNodes || c.port < 0 || !(c.start < c.end))
+            throw std::invalid_argument("ContactPlan: invalid contact");
+    std::sort(contacts.begin(), contacts.end(), [] (const Contact& a, const Contact& b) {
+        if (a.from != b.from) return a.from < b.from;
+        if (a.port != b.port) return a.port < b.port;
+        if (a.to != b.to) return a.to < b.to;
+        return a.start < b.start;
+    });
+
+    // a link is a run of contacts with the same (from, port, to)
+    nodeLinks.assign(numNodes + 1, 0);
+    linkContacts.clear();
+    for (int i = 0; i < (int)contacts.size(); i++) {
+        const Contact& c = contacts[i];
+        if (i == 0 || c.from != contacts[i - 1].from || c.port != contacts[i - 1].port || c.to != contacts[i - 1].to) {
+            linkContacts.push_back(i);
+            nodeLinks[c.from + 1]++;
+        }
+        else if (c.start < contacts[i - 1].end)
+            throw std::invalid_argument("ContactPlan: overlapping contacts on the same link");
+    }
+    linkContacts.push_back(contacts.size());
+    for (int u = 0; u < numNodes; u++)
+        nodeLinks[u + 1] += nodeLinks[u];
+
+    boundaries.clear();
+    boundaries.reserve(2 * contacts.size());
+    for (const Contact& c : contacts) {
+        boundaries.push_back(c.start);
+        boundaries.push_back(c.end);
+    }
+    std::sort(boundaries.begin(), boundaries.end());
+    boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+}
+
+double ContactPlan::getNextBoundary(double t) const
+{
+    auto it = std::upper_bound(boundaries.begin(), boundaries.end(), t);
+    return it != boundaries.end() && *it < endTime ? *it : endTime;
+}
+
+void ContactPlan::calculateEarliestArrival(int source, double t, std::vector<double>& arrival, std::vector<int>& firstPort) const
+{
+    const double infinity = std::numeric_limits<double>::infinity();
+    arrival.assign(numNodes, infinity);
+    firstPort.assign(numNodes, -1);
+    if (source < 0 || source >= numNodes)
+        return;
+
+    IndexedHeap<> heap;
+    heap.reset(numNodes);
+    arrival[source] = t;
+    heap.push(source, t);
+    while (!heap.isEmpty()) {
+        int u = heap.pop();
+        double a = arrival[u];
+        for (int k = nodeLinks[u]; k < nodeLinks[u + 1]; k++) {
+            // skip the contacts of the link that end before the arrival at u
+            auto first = contacts.begin() + linkContacts[k], last = contacts.begin() + linkContacts[k + 1];
+            auto it = std::partition_point(first, last, [a] (const Contact& c) { return c.end <= a; });
+            for (; it != last; ++it) {
+                int v = it->to;
+                // arriving through this or a later contact takes longer than start + delay
+                if (it->start >= arrival[v])
+                    break;
+                double candidate = std::max(a, it->start) + it->delay;
+                if (candidate < arrival[v]) {
+                    arrival[v] = candidate;
+                    firstPort[v] = u == source ? it->port : firstPort[u];
+                    heap.push(v, candidate);
+                }
+            }
+        }
+    }
+}
+
+} // namespace leolab
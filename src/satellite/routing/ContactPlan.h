@@ -0,0 +1,107 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef SATELLITE_ROUTING_CONTACTPLAN_H_
+#define SATELLITE_ROUTING_CONTACTPLAN_H_
+
+#include <vector>
+
+namespace leolab {
+
+/**
+ * A contact plan: the predicted availability windows ("contacts") of the
+ * links of a time-varying network over a finite horizon, and an
+ * earliest-arrival search over them (contact graph routing).
+ *
+ * A contact is a directed link from one node to another through a given
+ * output port that is usable during [start, end) with a constant one-way
+ * delay, e.g. the worst-case delay of the interval. A link, identified by
+ * (from, port, to), is described by one contact per interval in which it is
+ * up and is simply absent between its contacts; the same port may lead to
+ * different nodes over time (handovers). Contacts of the same link must not
+ * overlap.
+ *
+ * The plan is built by adding contacts and calling finalize(), which sorts
+ * them by (from, port, to, start) and indexes them per node and per link.
+ */
+class ContactPlan
+{
+  public:
+    struct Contact {
+        int from = -1;                  // transmitting node
+        int to = -1;                    // receiving node
+        int port = -1;                  // output port (gate index) at the transmitting node
+        double start = 0;               // first instant the contact is usable (s)
+        double end = 0;                 // end of the contact, exclusive (s)
+        double delay = 0;               // one-way delay during the contact (s)
+    };
+
+  protected:
+    int numNodes = 0;
+    double startTime = 0;               // beginning of the horizon (s)
+    double endTime = 0;                 // end of the horizon (s)
+    std::vector<Contact> contacts;      // sorted by (from, port, to, start) after finalize()
+    std::vector<int> nodeLinks;         // links of node u: [nodeLinks[u], nodeLinks[u + 1])
+    std::vector<int> linkContacts;      // contacts of link k: [linkContacts[k], linkContacts[k + 1])
+    std::vector<double> boundaries;     // sorted distinct contact start and end times
+
+  public:
+    ContactPlan() { }
+
+    /**
+     * Removes all contacts and sets up an empty plan of the given nodes over
+     * the horizon [startTime, endTime).
+     */
+    void clear(int numNodes, double startTime, double endTime);
+
+    /**
+     * Adds a contact; call finalize() after the last one.
+     */
+    void addContact(const Contact& contact);
+
+    /**
+     * Sorts and indexes the contacts. Throws std::invalid_argument on
+     * contacts with invalid nodes or overlapping contacts of the same link.
+     */
+    void finalize();
+
+    int getNumNodes() const { return numNodes; }
+    int getNumContacts() const { return contacts.size(); }
+    const Contact& getContact(int i) const { return contacts[i]; }
+    double getStartTime() const { return startTime; }
+    double getEndTime() const { return endTime; }
+
+    /**
+     * Returns the first contact start or end strictly after t, i.e. the next
+     * instant at which the contact graph changes; the end of the horizon if
+     * there is none.
+     */
+    double getNextBoundary(double t) const;
+
+    /**
+     * Computes the earliest arrival time at every node of a message leaving
+     * the source at time t (Dijkstra over contacts: a contact can be used if
+     * it ends after the arrival at its transmitting node, transmission waits
+     * for the contact to start). arrival[v] is infinity for nodes that cannot
+     * be reached within the horizon; firstPort[v] is the output port of the
+     * first contact on the earliest-arrival path to v, or -1 for the source
+     * and unreachable nodes.
+     */
+    void calculateEarliestArrival(int source, double t, std::vector<double>& arrival, std::vector<int>& firstPort) const;
+};
+
+} // namespace leolab
+
+#endif /* SATELLITE_ROUTING_CONTACTPLAN_H_ */
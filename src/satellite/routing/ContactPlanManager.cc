@@ -0,0 +1,226 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "ContactPlanManager.h"
+#include "../mobility/CircularOrbitMobility.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+Define_Module(ContactPlanManager);
+
+static const int SATELLITE_GROUND_PORT = 4;         // 卫星接入地面终端的 ethg 门下标（与配置器一致）
+static const int TERMINAL_PORT = 0;                 // 地面终端接入卫星的 ethg 门下标
+
+ContactPlanManager::ContactPlanManager() { }
+
+ContactPlanManager::~ContactPlanManager() { }
+
+void ContactPlanManager::initialize()
+{
+    horizon = par("horizon").doubleValue();
+    stepSize = par("stepSize").doubleValue();
+    if (stepSize <= 0 || horizon < stepSize)
+        throw cRuntimeError("ContactPlanManager: stepSize must be positive and not larger than horizon");
+    topologyManager.reference(this, "topologyManagerModule", true);
+    topologyConfigurator.reference(this, "topologyConfiguratorModule", false);
+}
+
+void ContactPlanManager::handleMessage(cMessage *msg)
+{
+    throw cRuntimeError("ContactPlanManager: this module does not process messages");
+}
+
+void ContactPlanManager::finish()
+{
+    recordScalar("contactPlansBuilt", numBuilds);
+}
+
+const ContactPlan *ContactPlanManager::getContactPlan()
+{
+    double now = simTime().dbl();
+    if (numBuilds == 0 || now + stepSize > plan.getEndTime() || topologyManager->getEpoch() != topologyEpoch)
+        buildContactPlan(now);
+    return &plan;
+}
+
+void ContactPlanManager::buildContactPlan(double startTime)
+{
+    const CsrGraph& graph = topologyManager->getTopology()->getCsrGraph();
+    topologyEpoch = topologyManager->getEpoch();
+    numSatellites = graph.getNumNodes();
+    int numEdges = graph.getNumEdges();
+    if (numSatellites == 0)
+        throw cRuntimeError("ContactPlanManager: the topology has no nodes");
+
+    // CSR 节点 -> 卫星下标，以及每颗卫星的轨道参数（由 WalkerDeltaTopologyConfigurator 写入 mobility 参数），按卫星下标存放
+    struct Orbit {
+        double initPhase, alpha, altitude, rightAscension, earthRotationRate, omega;
+    };
+    std::vector<int> satelliteIndex(numSatellites);
+    std::vector<Orbit> orbits(numSatellites);
+    std::vector<uint8_t> seen(numSatellites, 0);
+    cModule *satelliteVector = nullptr;
+    for (int i = 0; i < numSatellites; i++) {
+        cModule *node = getSimulation()->getModule(graph.getModuleId(i));
+        if (!node->isVector() || node->getVectorSize() != numSatellites || seen[node->getIndex()])
+            throw cRuntimeError("ContactPlanManager: topology node %s is not an element of a %d-node vector", node->getFullPath().c_str(), numSatellites);
+        CircularOrbitMobility *mobility = dynamic_cast<CircularOrbitMobility *>(node->getSubmodule("mobility"));
+        if (mobility == nullptr)
+            throw cRuntimeError("ContactPlanManager: %s does not use CircularOrbitMobility, its contacts are not predictable", node->getFullPath().c_str());
+        int index = node->getIndex();
+        seen[index] = 1;
+        satelliteIndex[i] = index;
+        satelliteVector = node;
+        double altitude = mobility->par("altitude").doubleValue();
+        orbits[index] = { mobility->par("initPhase").doubleValue(), mobility->par("alpha").doubleValue(), altitude,
+                          mobility->par("rightAscension").doubleValue(), mobility->par("earthRotationRate").doubleValue(),
+                          CircularOrbitMobility::computeAngularVelocity(altitude) };
+    }
+
+    // 地面终端：固定位置，以及当前接入的卫星下标（未接入为 -1）
+    std::vector<GeodeticPosition> terminals;
+    std::vector<int> serving;
+    double handoverInterval = 0;
+    if (topologyConfigurator.get() != nullptr) {
+        const char *groundHostModuleName = topologyConfigurator->par("groundHostModuleName").stringValue();
+        handoverInterval = topologyConfigurator->par("updateInterval").doubleValue();
+        cModule *network = satelliteVector->getParentModule();
+        if (*groundHostModuleName && network->hasSubmoduleVector(groundHostModuleName)) {
+            for (int g = 0; g < network->getSubmoduleVectorSize(groundHostModuleName); g++) {
+                cModule *terminal = network->getSubmodule(groundHostModuleName, g);
+                terminals.push_back(GeodeticPosition(terminal->par("longitude").doubleValue(), terminal->par("latitude").doubleValue(),
+                                                     terminal->par("altitude").doubleValue()));
+                cGate *gate = terminal->gate("ethg$o", TERMINAL_PORT)->getNextGate();
+                serving.push_back(gate != nullptr && gate->getOwnerModule()->getParentModule() == network ? gate->getOwnerModule()->getIndex() : -1);
+            }
+        }
+    }
+    int numTerminals = terminals.size();
+
+    // 卫星在 t 时刻的位置（与 CircularOrbitMobility 相同的闭式公式和球形地球）
+    auto satellitePosition = [&] (int index, double t) {
+        const Orbit& orbit = orbits[index];
+        return CircularOrbitMobility::computePosition(orbit.initPhase, orbit.alpha, orbit.altitude, orbit.rightAscension,
+                                                      orbit.earthRotationRate, orbit.omega, t);
+    };
+
+    // 采样时刻的卫星位置：positions[k * numSatellites + 卫星下标]
+    int numSteps = (int)std::ceil(horizon / stepSize);
+    double endTime = startTime + horizon;
+    std::vector<double> times(numSteps + 1);
+    for (int k = 0; k <= numSteps; k++)
+        times[k] = std::min(startTime + k * stepSize, endTime);
+    std::vector<GeodeticPosition> positions((size_t)(numSteps + 1) * numSatellites);
+    for (int k = 0; k <= numSteps; k++)
+        for (int index = 0; index < numSatellites; index++)
+            positions[(size_t)k * numSatellites + index] = satellitePosition(index, times[k]);
+
+    auto start = std::chrono::steady_clock::now();
+    plan.clear(numSatellites + numTerminals, startTime, endTime);
+
+    // 星间链路一直可用：每条已启用的链路一个接触，时延取各采样时刻的最大值
+    for (int e = 0; e < numEdges; e++) {
+        if (!graph.isEdgeEnabled(e))
+            continue;
+        ContactPlan::Contact contact;
+        contact.from = satelliteIndex[graph.getEdgeSource(e)];
+        contact.to = satelliteIndex[graph.getEdgeDestination(e)];
+        contact.port = getSimulation()->getModule(graph.getModuleId(graph.getEdgeSource(e)))->gate(graph.getEdgeSourceGateId(e))->getIndex();
+        contact.start = startTime;
+        contact.end = endTime;
+        for (int k = 0; k <= numSteps; k++) {
+            const GeodeticPosition *row = &positions[(size_t)k * numSatellites];
+            contact.delay = std::max(contact.delay, row[contact.from].distanceTo(row[contact.to]) / SPEED_OF_LIGHT);
+        }
+        plan.addContact(contact);
+    }
+
+    // 终端 g 在 [from, to) 内接入卫星 index：一对双向接触，时延取区间两端及其中各采样时刻的最大值
+    auto addGroundContacts = [&] (int g, int index, double from, double to) {
+        if (index == -1 || !(from < to))
+            return;
+        double distance = std::max(terminals[g].distanceTo(satellitePosition(index, from)), terminals[g].distanceTo(satellitePosition(index, to)));
+        for (int k = 0; k <= numSteps; k++)
+            if (times[k] > from && times[k] < to)
+                distance = std::max(distance, terminals[g].distanceTo(positions[(size_t)k * numSatellites + index]));
+        ContactPlan::Contact contact;
+        contact.start = from;
+        contact.end = to;
+        contact.delay = distance / SPEED_OF_LIGHT;
+        contact.from = numSatellites + g;
+        contact.to = index;
+        contact.port = TERMINAL_PORT;
+        plan.addContact(contact);
+        contact.from = index;
+        contact.to = numSatellites + g;
+        contact.port = SATELLITE_GROUND_PORT;
+        plan.addContact(contact);
+    };
+
+    // 在配置器之后的每个更新时刻重演 updateGroundToSatelliteLinks()：终端依次处理，
+    // 只在有未接入其他终端、且严格更近的卫星时切换，被让出的卫星可供之后的终端使用
+    std::vector<double> segmentStart(numTerminals, startTime);
+    if (numTerminals > 0 && handoverInterval > 0) {
+        std::vector<uint8_t> occupied(numSatellites, 0);
+        for (int index : serving)
+            if (index != -1)
+                occupied[index] = 1;
+        std::vector<GeodeticPosition> current(numSatellites);
+        for (double m = std::floor(startTime / handoverInterval) + 1; m * handoverInterval < endTime; m++) {
+            double t = m * handoverInterval;
+            for (int index = 0; index < numSatellites; index++)
+                current[index] = satellitePosition(index, t);
+            for (int g = 0; g < numTerminals; g++) {
+                int best = serving[g];
+                double bestDistance = best != -1 ? terminals[g].distanceTo(current[best]) : DBL_MAX;
+                for (int index = 0; index < numSatellites; index++) {
+                    if (occupied[index])
+                        continue;
+                    double distance = terminals[g].distanceTo(current[index]);
+                    if (distance < bestDistance) {
+                        best = index;
+                        bestDistance = distance;
+                    }
+                }
+                if (best == serving[g])
+                    continue;
+                addGroundContacts(g, serving[g], segmentStart[g], t);
+                if (serving[g] != -1)
+                    occupied[serving[g]] = 0;
+                occupied[best] = 1;
+                serving[g] = best;
+                segmentStart[g] = t;
+            }
+        }
+    }
+    for (int g = 0; g < numTerminals; g++)
+        addGroundContacts(g, serving[g], segmentStart[g], endTime);
+
+    plan.finalize();
+    numBuilds++;
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    EV_INFO << "ContactPlanManager: predicted " << plan.getNumContacts() << " contact(s) of " << numSatellites << " satellite(s) and "
+            << numTerminals << " terminal(s) over [" << startTime << "s, " << endTime << "s) in " << elapsed.count() << "s" << endl;
+}
+
+} // namespace leolab
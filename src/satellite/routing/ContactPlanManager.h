@@ -0,0 +1,83 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef SATELLITE_ROUTING_CONTACTPLANMANAGER_H_
+#define SATELLITE_ROUTING_CONTACTPLANMANAGER_H_
+
+#include <omnetpp.h>
+#include "inet/common/INETDefs.h"
+#include "inet/common/ModuleRefByPar.h"
+#include "ContactPlan.h"
+#include "TopologyManager.h"
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+/**
+ * 网络级接触计划（contact plan）生成服务，预测 WalkerDeltaTopologyConfigurator 实际建立的链路。
+ * - 卫星位置由 CircularOrbitMobility 的闭式公式给出，可以提前预测每条链路何时可用、时延多大
+ * - 星间链路：配置器建立的四条链路一直存在，每条已启用的链路在整个预测时长内为一个接触
+ * - 星地链路：在配置器的每个更新时刻（updateInterval 的整数倍）按 updateGroundToSatelliteLinks() 的规则
+ *   预测切换：终端依次保持当前卫星，除非有未接入其他终端且更近的卫星；每段接入区间为一对双向接触
+ * - 每个接触覆盖链路的一整段可用区间，时延取区间内按 stepSize 采样的传播时延的最大值，
+ *   因此计划只在星地切换时刻变化
+ * - 计划按需生成：第一次使用、剩余不足一个采样步或拓扑版本变化时重新生成
+ * - 节点编号：卫星为其在模块向量中的下标，地面终端 g 为卫星数 + g；接触的端口为 ethg 门下标。
+ *   ContactGraphRouting 在其上计算最早到达路由
+ */
+class ContactPlanManager : public cSimpleModule
+{
+  protected:
+    // ---------- 参数 ----------
+    double horizon = 0;                 // 预测时长（s）
+    double stepSize = 0;                // 采样步长（s）
+    ModuleRefByPar<TopologyManager> topologyManager;    // 提供星间链路拓扑
+    ModuleRefByPar<cModule> topologyConfigurator;       // 建立星地链路的拓扑配置器，可选
+
+    // ---------- 接触计划 ----------
+    ContactPlan plan;                   // 当前的接触计划
+    int topologyEpoch = -1;             // 生成计划时使用的拓扑版本号
+    int numSatellites = 0;              // 计划中的卫星数（节点 0 .. numSatellites - 1）
+    int numBuilds = 0;                  // 生成计划的次数
+
+  protected:
+    // OMNeT++ 生命周期
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+
+    // 从 startTime 起生成 horizon 时长的接触计划
+    virtual void buildContactPlan(double startTime);
+
+  public:
+    ContactPlanManager();
+    virtual ~ContactPlanManager();
+
+    /**
+     * 返回覆盖当前仿真时刻的接触计划，必要时重新生成。
+     */
+    const ContactPlan *getContactPlan();
+
+    /**
+     * 返回计划中的卫星数；编号不小于它的节点为地面终端。
+     */
+    int getNumSatellites() { getContactPlan(); return numSatellites; }
+};
+
+} // namespace leolab
+
+#endif /* SATELLITE_ROUTING_CONTACTPLANMANAGER_H_ */
@@ -0,0 +1,627 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "CsrGraph.h"
+
+#include <algorithm>
+#include <climits>
+
+#include "IndexedHeap.h"
+#include "Topology.h"
+#include "WorkerPool.h"
+
+namespace leolab {
+
+void CsrGraph::clear()
+{
+    moduleIds.clear();
+    nodeWeights.clear();
+    nodeEnabled.clear();
+    outBegin.clear();
+    edgeSrc.clear();
+    edgeDest.clear();
+    edgeSrcGateId.clear();
+    edgeDestGateId.clear();
+    edgeWeights.clear();
+    edgeEnabled.clear();
+    inBegin.clear();
+    inEdges.clear();
+    inEdgeIndex.clear();
+    inSrc.clear();
+    inWeights.clear();
+}
+
+void CsrGraph::build(const Topology& topology)
+{
+    clear();
+
+    int numNodes = topology.getNumNodes();
+    int numEdges = 0;
+    moduleIds.reserve(numNodes);
+    nodeWeights.reserve(numNodes);
+    nodeEnabled.reserve(numNodes);
+    for (int i = 0; i < numNodes; i++) {
+        const Topology::Node *node = topology.getNode(i);
+        moduleIds.push_back(node->getModuleId());
+        nodeWeights.push_back(node->getWeight());
+        nodeEnabled.push_back(node->isEnabled());
+        numEdges += node->getNumOutLinks();
+    }
+
+    // outgoing edges, in the order of Node::outLinks
+    outBegin.reserve(numNodes + 1);
+    edgeSrc.reserve(numEdges);
+    edgeDest.reserve(numEdges);
+    edgeSrcGateId.reserve(numEdges);
+    edgeDestGateId.reserve(numEdges);
+    edgeWeights.reserve(numEdges);
+    edgeEnabled.reserve(numEdges);
+    for (int i = 0; i < numNodes; i++) {
+        const Topology::Node *node = topology.getNode(i);
+        outBegin.push_back(edgeDest.size());
+        for (int j = 0; j < node->getNumOutLinks(); j++) {
+            const Topology::Link *link = node->getLinkOut(j);
+            edgeSrc.push_back(i);
+            edgeDest.push_back(link->getLinkOutRemoteNode()->getIndex());
+            edgeSrcGateId.push_back(link->getLinkOutLocalGateId());
+            edgeDestGateId.push_back(link->getLinkOutRemoteGateId());
+            edgeWeights.push_back(link->getWeight());
+            edgeEnabled.push_back(link->isEnabled());
+        }
+    }
+    outBegin.push_back(edgeDest.size());
+
+    // incoming edges: counting sort of the edge indices by destination node
+    inBegin.assign(numNodes + 1, 0);
+    for (int dest : edgeDest)
+        inBegin[dest + 1]++;
+    for (int i = 0; i < numNodes; i++)
+        inBegin[i + 1] += inBegin[i];
+    inEdges.resize(numEdges);
+    std::vector<int> fill(inBegin.begin(), inBegin.end() - 1);
+    for (int e = 0; e < numEdges; e++)
+        inEdges[fill[edgeDest[e]]++] = e;
+
+    inEdgeIndex.resize(numEdges);
+    inSrc.resize(numEdges);
+    inWeights.resize(numEdges);
+    for (int i = 0; i < numEdges; i++) {
+        int e = inEdges[i];
+        inEdgeIndex[e] = i;
+        inSrc[i] = edgeSrc[e];
+        updateInWeight(e);
+    }
+}
+
+void CsrGraph::setNodeEnabled(int node, bool enabled)
+{
+    nodeEnabled[node] = enabled;
+    for (int i = inBegin[node]; i < inBegin[node + 1]; i++)
+        updateInWeight(inEdges[i]);
+}
+
+int CsrGraph::findNode(int moduleId) const
+{
+    // moduleIds[] is ordered like Topology::nodes[], i.e. by (unsigned) module ID
+    auto it = std::lower_bound(moduleIds.begin(), moduleIds.end(), moduleId,
+            [] (int a, int b) { return (unsigned int)a < (unsigned int)b; });
+    return it == moduleIds.end() || *it != moduleId ? -1 : it - moduleIds.begin();
+}
+
+int CsrGraph::findEdge(int node, int srcGateId) const
+{
+    for (int e = outBegin[node]; e < outBegin[node + 1]; e++)
+        if (edgeSrcGateId[e] == srcGateId)
+            return e;
+    return -1;
+}
+
+void CsrGraph::resetTree(int root, ShortestPathTree& tree) const
+{
+    if (root < 0 || root >= getNumNodes())
+        throw cRuntimeError("CsrGraph: invalid root node index %d", root);
+    tree.root = root;
+    tree.dist.assign(getNumNodes(), INFINITY);
+    tree.predEdge.assign(getNumNodes(), -1);
+    tree.firstEdge.assign(getNumNodes(), -1);
+    tree.dist[root] = 0;
+}
+
+void CsrGraph::calculateShortestPathsFrom(int source, ShortestPathTree& tree) const
+{
+    resetTree(source, tree);
+
+    IndexedHeap<> q;
+    q.reset(getNumNodes());
+    q.push(source, 0);
+    while (!q.isEmpty()) {
+        int u = q.pop();
+
+        double base = tree.dist[u];
+        if (u != source)
+            base += nodeWeights[u]; // price of routing through u
+        int firstEdge = tree.firstEdge[u];
+        for (int e = outBegin[u]; e < outBegin[u + 1]; e++) {
+            if (!edgeEnabled[e])
+                continue;
+            int v = edgeDest[e];
+            if (!nodeEnabled[v])
+                continue;
+            double newdist = base + edgeWeights[e];
+            if (newdist != INFINITY && newdist < tree.dist[v]) {
+                tree.dist[v] = newdist;
+                tree.predEdge[v] = e;
+                tree.firstEdge[v] = u == source ? e : firstEdge;
+                q.push(v, newdist); // insert or decrease-key
+            }
+        }
+    }
+}
+
+void CsrGraph::calculateShortestPathsTo(int target, ShortestPathTree& tree) const
+{
+    resetTree(target, tree);
+
+    IndexedHeap<> q;
+    q.reset(getNumNodes());
+    q.push(target, 0);
+    while (!q.isEmpty()) {
+        int v = q.pop();
+
+        double base = tree.dist[v];
+        if (v != target)
+            base += nodeWeights[v]; // price of routing through v
+        for (int i = inBegin[v]; i < inBegin[v + 1]; i++) {
+            int e = inEdges[i];
+            if (!edgeEnabled[e])
+                continue;
+            int u = edgeSrc[e];
+            if (!nodeEnabled[u])
+                continue;
+            double newdist = base + edgeWeights[e];
+            if (newdist != INFINITY && newdist < tree.dist[u]) {
+                tree.dist[u] = newdist;
+                tree.predEdge[u] = e;
+                q.push(u, newdist); // insert or decrease-key
+            }
+        }
+    }
+}
+
+int CsrGraph::updateShortestPathsFrom(ShortestPathTree& tree, const std::vector<int>& changedEdges) const
+{
+    if (tree.root < 0 || tree.root >= getNumNodes() || (int)tree.dist.size() != getNumNodes())
+        throw cRuntimeError("CsrGraph: shortest path tree does not belong to this graph");
+
+    int source = tree.root;
+    auto distVia = [&] (int e) {
+        // length of the path to edgeDest[e] that ends with edge e, INFINITY if e is unusable
+        int u = edgeSrc[e];
+        if (!edgeEnabled[e] || !nodeEnabled[edgeDest[e]] || tree.dist[u] == INFINITY)
+            return (double)INFINITY;
+        return tree.dist[u] + (u != source ? nodeWeights[u] : 0) + edgeWeights[e];
+    };
+    auto firstEdgeVia = [&] (int e) {
+        int u = edgeSrc[e];
+        return u == source ? e : tree.firstEdge[u];
+    };
+
+    // 1) tree edges that got more expensive (or were disabled): every node in
+    //    their subtree loses its distance; the tree is still consistent at this
+    //    point, so a changed tree edge is recognized by its stale distance
+    std::vector<int> affected;
+    for (int e : changedEdges) {
+        int v = edgeDest[e];
+        if (tree.predEdge[v] == e && tree.dist[v] != INFINITY && distVia(e) > tree.dist[v]) {
+            affected.push_back(v);
+            tree.dist[v] = INFINITY;    // also marks v as collected
+        }
+    }
+    for (size_t i = 0; i < affected.size(); i++) {
+        int u = affected[i];
+        for (int e = outBegin[u]; e < outBegin[u + 1]; e++) {
+            int v = edgeDest[e];
+            if (tree.predEdge[v] == e && tree.dist[v] != INFINITY) {
+                affected.push_back(v);
+                tree.dist[v] = INFINITY;
+            }
+        }
+    }
+    for (int v : affected) {
+        tree.predEdge[v] = -1;
+        tree.firstEdge[v] = -1;
+    }
+
+    IndexedHeap<> q;
+    q.reset(getNumNodes());
+    int numChanged = affected.size();
+
+    // 2) reattach the detached nodes from their in-neighbors; detached
+    //    in-neighbors still have INFINITY and are skipped by distVia()
+    for (int v : affected) {
+        for (int i = inBegin[v]; i < inBegin[v + 1]; i++) {
+            int e = inEdges[i];
+            double newdist = distVia(e);
+            if (newdist != INFINITY && newdist < tree.dist[v]) {
+                tree.dist[v] = newdist;
+                tree.predEdge[v] = e;
+                tree.firstEdge[v] = firstEdgeVia(e);
+            }
+        }
+        if (tree.dist[v] != INFINITY)
+            q.push(v, tree.dist[v]);
+    }
+
+    // 3) edges that got cheaper (or were enabled) may shorten some paths
+    for (int e : changedEdges) {
+        int v = edgeDest[e];
+        double newdist = distVia(e);
+        if (v != source && newdist != INFINITY && newdist < tree.dist[v]) {
+            tree.dist[v] = newdist;
+            tree.predEdge[v] = e;
+            tree.firstEdge[v] = firstEdgeVia(e);
+            q.push(v, newdist);
+            numChanged++;
+        }
+    }
+
+    // 4) propagate the new distances, like calculateShortestPathsFrom()
+    while (!q.isEmpty()) {
+        int u = q.pop();
+        double base = tree.dist[u] + (u != source ? nodeWeights[u] : 0);
+        for (int e = outBegin[u]; e < outBegin[u + 1]; e++) {
+            if (!edgeEnabled[e])
+                continue;
+            int v = edgeDest[e];
+            if (!nodeEnabled[v])
+                continue;
+            double newdist = base + edgeWeights[e];
+            if (newdist != INFINITY && newdist < tree.dist[v]) {
+                tree.dist[v] = newdist;
+                tree.predEdge[v] = e;
+                tree.firstEdge[v] = firstEdgeVia(e);
+                q.push(v, newdist);
+                numChanged++;
+            }
+        }
+    }
+    return numChanged;
+}
+
+void CsrGraph::calculateBellmanFordShortestPathsFrom(int source, ShortestPathTree& tree) const
+{
+    resetTree(source, tree);
+
+    // at most N-1 rounds of relaxing every edge
+    int numNodes = getNumNodes();
+    int numEdges = getNumEdges();
+    for (int i = 0; i + 1 < numNodes; i++) {
+        bool anyChange = false;
+        for (int e = 0; e < numEdges; e++) {
+            int u = edgeSrc[e];
+            int v = edgeDest[e];
+            if (!edgeEnabled[e] || !nodeEnabled[v] || tree.dist[u] == INFINITY)
+                continue;
+            double newdist = tree.dist[u] + edgeWeights[e];
+            if (newdist < tree.dist[v]) {
+                tree.dist[v] = newdist;
+                tree.predEdge[v] = e;
+                tree.firstEdge[v] = u == source ? e : tree.firstEdge[u];
+                anyChange = true;
+            }
+        }
+        if (!anyChange)
+            break;
+    }
+
+    // Nth round: negative cycle detection
+    for (int e = 0; e < numEdges; e++) {
+        int u = edgeSrc[e];
+        int v = edgeDest[e];
+        if (edgeEnabled[e] && nodeEnabled[v] && tree.dist[u] != INFINITY && tree.dist[u] + edgeWeights[e] < tree.dist[v])
+            throw cRuntimeError("CsrGraph: negative weight cycle reachable from source node");
+    }
+}
+
+void CsrGraph::calculateSpfaShortestPathsFrom(int source, ShortestPathTree& tree) const
+{
+    resetTree(source, tree);
+
+    int numNodes = getNumNodes();
+    std::vector<int> queue(numNodes);           // circular FIFO, holds each node at most once
+    std::vector<uint8_t> inQueue(numNodes, 0);
+    std::vector<int> pathLength(numNodes, 0);   // number of edges on the current path
+    int head = 0, size = 0;
+
+    queue[0] = source;
+    inQueue[source] = 1;
+    size = 1;
+    while (size > 0) {
+        int u = queue[head];
+        head = head + 1 == numNodes ? 0 : head + 1;
+        size--;
+        inQueue[u] = 0;
+
+        double base = tree.dist[u];
+        for (int e = outBegin[u]; e < outBegin[u + 1]; e++) {
+            int v = edgeDest[e];
+            if (!edgeEnabled[e] || !nodeEnabled[v])
+                continue;
+            double newdist = base + edgeWeights[e];
+            if (newdist < tree.dist[v]) {
+                tree.dist[v] = newdist;
+                tree.predEdge[v] = e;
+                tree.firstEdge[v] = u == source ? e : tree.firstEdge[u];
+                // a simple path has at most N-1 edges
+                pathLength[v] = pathLength[u] + 1;
+                if (pathLength[v] >= numNodes)
+                    throw cRuntimeError("CsrGraph: negative weight cycle reachable from source node");
+                if (!inQueue[v]) {
+                    int tail = head + size < numNodes ? head + size : head + size - numNodes;
+                    queue[tail] = v;
+                    inQueue[v] = 1;
+                    size++;
+                }
+            }
+        }
+    }
+}
+
+void CsrGraph::calculateBellmanFordSweepShortestPathsFrom(int source, ShortestPathTree& tree) const
+{
+    resetTree(source, tree);
+
+    // edge lists grouped by destination, disabled edges have an infinite weight
+    int numNodes = getNumNodes();
+
+    // at most N-1 rounds, plus one to detect negative cycles
+    for (int round = 0; round < numNodes; round++) {
+        bool anyChange = false;
+        for (int v = 0; v < numNodes; v++) {
+            double best = tree.dist[v];
+            int bestIndex = -1;
+            for (int i = inBegin[v]; i < inBegin[v + 1]; i++) {
+                double candidate = tree.dist[inSrc[i]] + inWeights[i];
+                if (candidate < best) {
+                    best = candidate;
+                    bestIndex = i;
+                }
+            }
+            if (bestIndex != -1) {
+                tree.dist[v] = best;
+                tree.predEdge[v] = inEdges[bestIndex];
+                tree.firstEdge[v] = inSrc[bestIndex] == source ? inEdges[bestIndex] : tree.firstEdge[inSrc[bestIndex]];
+                anyChange = true;
+            }
+        }
+        if (!anyChange)
+            return;
+    }
+    throw cRuntimeError("CsrGraph: negative weight cycle reachable from source node");
+}
+
+double CsrGraph::getMeanEdgeWeight() const
+{
+    double sum = 0;
+    int count = 0;
+    for (int e = 0; e < getNumEdges(); e++) {
+        if (edgeEnabled[e] && edgeWeights[e] != INFINITY) {
+            sum += edgeWeights[e];
+            count++;
+        }
+    }
+    return count == 0 ? 1 : sum / count;
+}
+
+void CsrGraph::calculateDeltaSteppingShortestPathsFrom(int source, double delta, WorkerPool& pool, ShortestPathTree& tree) const
+{
+    if (!(delta > 0) || delta == INFINITY)
+        throw cRuntimeError("CsrGraph: invalid delta %g for delta-stepping", delta);
+    resetTree(source, tree);
+
+    struct Request {
+        int node;
+        int edge;
+        int firstEdge;
+        double dist;
+    };
+    // minimum number of out-edges per chunk: small enough that a frontier of
+    // a few dozen nodes is spread over the pool. Merging the chunks in order
+    // applies the requests in node order however the nodes are split, so
+    // the tree does not depend on the chunk size or the thread count.
+    const int MIN_EDGES_PER_CHUNK = 32;
+    int numThreads = pool.getNumThreads();
+
+    std::vector<std::vector<int>> buckets(1, std::vector<int>(1, source));
+    std::vector<std::vector<Request>> chunkRequests;
+    std::vector<int> chunkBegin;    // index of the first node of each chunk, plus the end
+    std::vector<uint8_t> inFrontier(getNumNodes(), 0);
+    std::vector<uint8_t> inSettled(getNumNodes(), 0);
+    auto bucketOf = [&] (double dist) { return (size_t)(dist / delta); };
+
+    // relaxes the light or heavy out-edges of the given nodes in parallel,
+    // then applies the improvements in chunk order
+    auto relax = [&] (const std::vector<int>& nodes, bool light) {
+        // split the nodes into chunks of about the same number of out-edges,
+        // a few per thread; a single thread takes all nodes in one chunk
+        int numEdges = 0;
+        for (int u : nodes)
+            numEdges += outBegin[u + 1] - outBegin[u];
+        int edgesPerChunk = numThreads == 1 ? INT_MAX : std::max(MIN_EDGES_PER_CHUNK, numEdges / (4 * numThreads));
+        chunkBegin.clear();
+        int numChunkEdges = edgesPerChunk;
+        for (int k = 0; k < (int)nodes.size(); k++) {
+            if (numChunkEdges >= edgesPerChunk) {
+                chunkBegin.push_back(k);
+                numChunkEdges = 0;
+            }
+            numChunkEdges += outBegin[nodes[k] + 1] - outBegin[nodes[k]];
+        }
+        int numChunks = chunkBegin.size();
+        chunkBegin.push_back(nodes.size());
+        if ((int)chunkRequests.size() < numChunks)
+            chunkRequests.resize(numChunks);
+        auto relaxChunk = [&] (int chunk) {
+            std::vector<Request>& requests = chunkRequests[chunk];
+            requests.clear();
+            for (int k = chunkBegin[chunk]; k < chunkBegin[chunk + 1]; k++) {
+                int u = nodes[k];
+                double base = tree.dist[u];
+                double nodeWeight = u != source ? nodeWeights[u] : 0; // price of routing through u
+                int firstEdge = tree.firstEdge[u];
+                for (int e = outBegin[u]; e < outBegin[u + 1]; e++) {
+                    double weight = nodeWeight + edgeWeights[e];
+                    int v = edgeDest[e];
+                    if ((weight <= delta) != light || !edgeEnabled[e] || !nodeEnabled[v])
+                        continue;
+                    double newdist = base + weight;
+                    if (newdist != INFINITY && newdist < tree.dist[v])
+                        requests.push_back({v, e, u == source ? e : firstEdge, newdist});
+                }
+            }
+        };
+        if (numChunks <= 1) {
+            if (numChunks == 1)
+                relaxChunk(0);
+        }
+        else
+            pool.parallelFor(numChunks, relaxChunk);
+
+        for (int chunk = 0; chunk < numChunks; chunk++) {
+            for (const Request& request : chunkRequests[chunk]) {
+                if (request.dist < tree.dist[request.node]) {
+                    tree.dist[request.node] = request.dist;
+                    tree.predEdge[request.node] = request.edge;
+                    tree.firstEdge[request.node] = request.firstEdge;
+                    size_t b = bucketOf(request.dist);
+                    if (b >= buckets.size())
+                        buckets.resize(b + 1);
+                    buckets[b].push_back(request.node);
+                }
+            }
+        }
+    };
+
+    std::vector<int> frontier;
+    std::vector<int> settled;
+    for (size_t b = 0; b < buckets.size(); b++) {
+        settled.clear();
+        while (!buckets[b].empty()) {
+            // nodes that are still in this bucket, each once (entries of
+            // nodes that have moved to a lower bucket are stale)
+            frontier.clear();
+            for (int v : buckets[b]) {
+                if (!inFrontier[v] && bucketOf(tree.dist[v]) == b) {
+                    inFrontier[v] = 1;
+                    frontier.push_back(v);
+                }
+            }
+            buckets[b].clear();
+            for (int v : frontier) {
+                inFrontier[v] = 0;
+                if (!inSettled[v]) {
+                    inSettled[v] = 1;
+                    settled.push_back(v);
+                }
+            }
+
+            // light edges may put nodes back into this bucket
+            relax(frontier, true);
+        }
+
+        // heavy edges only lead to later buckets
+        relax(settled, false);
+        for (int v : settled)
+            inSettled[v] = 0;
+        std::vector<int>().swap(buckets[b]);
+    }
+}
+
+void CsrGraph::calculateEqualCostFirstEdges(const ShortestPathTree& tree, std::vector<uint64_t>& firstEdgeMasks, double tolerance) const
+{
+    int root = tree.root;
+    if (getNumOutEdges(root) > 64)
+        throw cRuntimeError("CsrGraph: equal-cost first edges are limited to 64 out-edges, node %d has %d", root, getNumOutEdges(root));
+
+    // reachable nodes in the order of their distance (predecessors first)
+    std::vector<int> order;
+    order.reserve(getNumNodes());
+    for (int v = 0; v < getNumNodes(); v++)
+        if (v != root && tree.dist[v] != INFINITY)
+            order.push_back(v);
+    std::sort(order.begin(), order.end(), [&] (int a, int b) {
+        return tree.dist[a] < tree.dist[b] || (tree.dist[a] == tree.dist[b] && a < b);
+    });
+
+    firstEdgeMasks.assign(getNumNodes(), 0);
+    for (int v : order) {
+        double limit = tree.dist[v] + tree.dist[v] * tolerance;
+        uint64_t mask = 0;
+        for (int i = inBegin[v]; i < inBegin[v + 1]; i++) {
+            int e = inEdges[i];
+            int u = edgeSrc[e];
+            if (!edgeEnabled[e] || !nodeEnabled[u] || tree.dist[u] == INFINITY)
+                continue;
+            double cost = tree.dist[u] + (u != root ? nodeWeights[u] : 0) + edgeWeights[e];
+            if (cost <= limit)
+                mask |= u == root ? uint64_t(1) << (e - outBegin[root]) : firstEdgeMasks[u];
+        }
+        firstEdgeMasks[v] = mask;
+    }
+}
+
+int CsrGraph::calculateComponents(std::vector<int>& component, bool enabledOnly) const
+{
+    // union-find with union by size and path halving, parent[] doubles as the result
+    int numNodes = getNumNodes();
+    std::vector<int> parent(numNodes), size(numNodes, 1);
+    for (int v = 0; v < numNodes; v++)
+        parent[v] = v;
+    auto find = [&] (int v) {
+        while (parent[v] != v) {
+            parent[v] = parent[parent[v]];
+            v = parent[v];
+        }
+        return v;
+    };
+    for (int e = 0; e < getNumEdges(); e++) {
+        if (enabledOnly && (!edgeEnabled[e] || !nodeEnabled[edgeSrc[e]] || !nodeEnabled[edgeDest[e]]))
+            continue;
+        int a = find(edgeSrc[e]);
+        int b = find(edgeDest[e]);
+        if (a == b)
+            continue;
+        if (size[a] < size[b])
+            std::swap(a, b);
+        parent[b] = a;
+        size[a] += size[b];
+    }
+
+    // number the roots in the order of their smallest node
+    std::vector<int> label(numNodes, -1);
+    component.assign(numNodes, -1);
+    int numComponents = 0;
+    for (int v = 0; v < numNodes; v++) {
+        if (enabledOnly && !nodeEnabled[v])
+            continue;
+        int root = find(v);
+        if (label[root] == -1)
+            label[root] = numComponents++;
+        component[v] = label[root];
+    }
+    return numComponents;
+}
+
+} // namespace leolab
@@ -0,0 +1,271 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef SATELLITE_ROUTING_CSRGRAPH_H_
+#define SATELLITE_ROUTING_CSRGRAPH_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "inet/common/INETDefs.h"
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+class Topology;
+class WorkerPool;
+
+/**
+ * Compressed sparse row (adjacency array) representation of a Topology.
+ *
+ * Nodes and links are addressed by contiguous indices: node i corresponds to
+ * Topology::getNode(i), and the outgoing links of node i occupy the edge index
+ * range [getFirstOutEdge(i), getFirstOutEdge(i + 1)) in the same order as in
+ * Node::outLinks. Weights and enabled flags are kept in parallel arrays, so
+ * they can be updated in place without rebuilding the graph.
+ *
+ * The shortest path algorithms do not touch the graph; they write their
+ * results into a caller-owned ShortestPathTree, so one graph can be shared
+ * by many readers. The algorithms that search from a source propagate the
+ * first edge of the path along with the distance, so the outgoing edge of
+ * the source towards every node is known when the search ends.
+ */
+class CsrGraph
+{
+  public:
+    /**
+     * Result of a single-source shortest path computation.
+     */
+    struct ShortestPathTree {
+        int root = -1;                  // index of the source (or target) node
+        std::vector<double> dist;       // distance from the source (to the target)
+        std::vector<int> predEdge;      // last edge of the path from the source (first edge towards the target), -1 if none
+        std::vector<int> firstEdge;     // first edge of the path from the source, -1 if none; set by the ...From() algorithms
+    };
+
+  protected:
+    // nodes
+    std::vector<int> moduleIds;
+    std::vector<double> nodeWeights;
+    std::vector<uint8_t> nodeEnabled;
+
+    // edges, grouped by source node
+    std::vector<int> outBegin;
+    std::vector<int> edgeSrc;
+    std::vector<int> edgeDest;
+    std::vector<int> edgeSrcGateId;
+    std::vector<int> edgeDestGateId;
+    std::vector<double> edgeWeights;
+    std::vector<uint8_t> edgeEnabled;
+
+    // edge indices grouped by destination node
+    std::vector<int> inBegin;
+    std::vector<int> inEdges;
+
+    // the same edges as structure of arrays (source, effective weight) for
+    // the Bellman-Ford sweep; a disabled edge or destination node has an
+    // infinite weight, kept up to date by the setters
+    std::vector<int> inEdgeIndex;       // position of each edge in inEdges[]
+    std::vector<int> inSrc;
+    std::vector<double> inWeights;
+
+  protected:
+    void resetTree(int root, ShortestPathTree& tree) const;
+    void updateInWeight(int edge) { inWeights[inEdgeIndex[edge]] = edgeEnabled[edge] && nodeEnabled[edgeDest[edge]] ? edgeWeights[edge] : INFINITY; }
+
+  public:
+    /** @name Building the graph. */
+    //@{
+
+    /**
+     * Builds the adjacency arrays from the nodes and links of the topology.
+     */
+    void build(const Topology& topology);
+
+    /**
+     * Deletes the graph.
+     */
+    void clear();
+    //@}
+
+    /** @name Nodes. */
+    //@{
+    int getNumNodes() const { return moduleIds.size(); }
+    int getModuleId(int node) const { return moduleIds[node]; }
+    double getNodeWeight(int node) const { return nodeWeights[node]; }
+    void setNodeWeight(int node, double weight) { nodeWeights[node] = weight; }
+    bool isNodeEnabled(int node) const { return nodeEnabled[node]; }
+    void setNodeEnabled(int node, bool enabled);
+
+    /**
+     * Returns the index of the node that corresponds to the given module ID,
+     * or -1 if there is no such node.
+     */
+    int findNode(int moduleId) const;
+    //@}
+
+    /** @name Edges. */
+    //@{
+    int getNumEdges() const { return edgeDest.size(); }
+    int getFirstOutEdge(int node) const { return outBegin[node]; }
+    int getNumOutEdges(int node) const { return outBegin[node + 1] - outBegin[node]; }
+    int getFirstInEdge(int node) const { return inBegin[node]; }
+    int getNumInEdges(int node) const { return inBegin[node + 1] - inBegin[node]; }
+
+    /**
+     * Returns the edge index of the ith incoming edge of the node.
+     */
+    int getInEdge(int node, int i) const { return inEdges[inBegin[node] + i]; }
+
+    int getEdgeSource(int edge) const { return edgeSrc[edge]; }
+    int getEdgeDestination(int edge) const { return edgeDest[edge]; }
+    int getEdgeSourceGateId(int edge) const { return edgeSrcGateId[edge]; }
+    int getEdgeDestinationGateId(int edge) const { return edgeDestGateId[edge]; }
+    double getEdgeWeight(int edge) const { return edgeWeights[edge]; }
+    void setEdgeWeight(int edge, double weight) { edgeWeights[edge] = weight; updateInWeight(edge); }
+    bool isEdgeEnabled(int edge) const { return edgeEnabled[edge]; }
+    void setEdgeEnabled(int edge, bool enabled) { edgeEnabled[edge] = enabled; updateInWeight(edge); }
+
+    /**
+     * Returns the index of the outgoing edge of the node that starts at the
+     * given gate of the node's module, or -1 if there is no such edge.
+     */
+    int findEdge(int node, int srcGateId) const;
+    //@}
+
+    /** @name Algorithms to find shortest paths. */
+    //@{
+
+    /**
+     * Apply the Dijkstra algorithm to find the shortest paths from the given
+     * node. Uses weights in nodes and edges, and skips disabled ones.
+     */
+    void calculateShortestPathsFrom(int source, ShortestPathTree& tree) const;
+
+    /**
+     * Apply the Dijkstra algorithm to find the shortest paths to the given
+     * node. Uses weights in nodes and edges, and skips disabled ones.
+     */
+    void calculateShortestPathsTo(int target, ShortestPathTree& tree) const;
+
+    /**
+     * Apply the Bellman-Ford algorithm to find the shortest paths from the
+     * given node. Uses weights in edges, and skips disabled nodes and edges.
+     * Throws an error if a negative weight cycle is reachable from the source.
+     */
+    void calculateBellmanFordShortestPathsFrom(int source, ShortestPathTree& tree) const;
+
+    /**
+     * Bellman-Ford with a FIFO work queue (SPFA): only the out-edges of nodes
+     * whose distance has improved are relaxed, and a bitmap keeps each node
+     * in the queue at most once. Same semantics as
+     * calculateBellmanFordShortestPathsFrom(); a negative cycle is detected
+     * when a path reaches N edges.
+     */
+    void calculateSpfaShortestPathsFrom(int source, ShortestPathTree& tree) const;
+
+    /**
+     * Bellman-Ford over structure-of-arrays edge lists grouped by destination.
+     * Every round sweeps the nodes in order and pulls the minimum over the
+     * contiguous (source, weight) arrays of their in-edges, skipping no edge
+     * and chasing no pointers. The sweep is scalar: the distances of the
+     * sources are gathered and a +Grid node has only about four in-edges, so
+     * the gain over the classic variant is cache locality, not SIMD. The
+     * arrays are built with the graph and kept current by the setters, with
+     * disabled edges folded into an infinite weight. Same semantics as
+     * calculateBellmanFordShortestPathsFrom().
+     */
+    void calculateBellmanFordSweepShortestPathsFrom(int source, ShortestPathTree& tree) const;
+
+    /**
+     * Delta-stepping (Meyer and Sanders): nodes are kept in buckets of width
+     * delta, and the edges of a whole bucket are relaxed at once on the
+     * threads of the pool, light edges (weight <= delta) repeatedly until
+     * the bucket is empty, heavy edges once afterwards. Uses the same node
+     * and edge weights as calculateShortestPathsFrom(); weights must not be
+     * negative.
+     *
+     * The bucket is split by out-edge count into a few chunks per thread,
+     * of at least 32 out-edges each, so even the frontier of a +Grid torus
+     * (about 2 sqrt(N) nodes) is spread over the pool. Relaxation requests
+     * are collected per chunk and applied in chunk order, i.e. in node
+     * order, on the calling thread, so the resulting tree does not depend
+     * on the number of threads.
+     */
+    void calculateDeltaSteppingShortestPathsFrom(int source, double delta, WorkerPool& pool, ShortestPathTree& tree) const;
+
+    /**
+     * Returns the mean weight of the enabled edges, a reasonable default
+     * for the bucket width of delta-stepping.
+     */
+    double getMeanEdgeWeight() const;
+
+    /**
+     * Computes the first edges of all equal-cost shortest paths from the root
+     * of a tree computed by calculateShortestPathsFrom(). An edge (u, v)
+     * lies on a shortest path if the distance of u plus the weight of u (if u
+     * is not the root) plus the edge weight equals the distance of v, up to
+     * the given relative tolerance; the first edges of v are the union of
+     * those of all such u. Nodes are visited in the order of their distance,
+     * so only the root's own tree is needed.
+     *
+     * firstEdgeMasks[node] has bit i set if the ith out-edge of the root
+     * starts a shortest path to the node, and is 0 for the root and
+     * unreachable nodes. Throws an error if the root has more than 64
+     * out-edges.
+     */
+    void calculateEqualCostFirstEdges(const ShortestPathTree& tree, std::vector<uint64_t>& firstEdgeMasks, double tolerance = 1e-9) const;
+    //@}
+
+    /** @name Dynamic shortest paths. */
+    //@{
+
+    /**
+     * Repairs a tree computed by calculateShortestPathsFrom() after the weight
+     * or the enabled state of the given edges has been changed in place.
+     * Disabling an edge acts as edge deletion, enabling it as edge insertion.
+     *
+     * Only the affected part of the tree is recomputed (Ramalingam-Reps):
+     * the subtrees below tree edges that got more expensive are detached and
+     * reattached from their unaffected in-neighbors, and improvements from
+     * cheaper edges are propagated with a Dijkstra search seeded at their
+     * endpoints. Every change to the graph since the tree was computed must
+     * be listed in changedEdges; node weights and enabled flags must not
+     * change. Returns the number of label updates, i.e. zero if the tree has
+     * not changed.
+     */
+    int updateShortestPathsFrom(ShortestPathTree& tree, const std::vector<int>& changedEdges) const;
+    //@}
+
+    /** @name Connectivity. */
+    //@{
+
+    /**
+     * Labels the connected components of the graph, ignoring the direction
+     * of the edges, with union-find over the edges (no recursion, nearly
+     * linear time). Stores the component of every node into component[node];
+     * components are numbered from 0 in the order of their smallest node
+     * index. If enabledOnly is true, disabled edges are ignored and disabled
+     * nodes get -1. Returns the number of components.
+     */
+    int calculateComponents(std::vector<int>& component, bool enabledOnly = true) const;
+    //@}
+};
+
+} // namespace leolab
+
+#endif /* SATELLITE_ROUTING_CSRGRAPH_H_ */
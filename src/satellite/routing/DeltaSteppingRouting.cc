@@ -0,0 +1,52 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+
+#include "DeltaSteppingRouting.h"
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+Define_Module(DeltaSteppingRouting);
+
+DeltaSteppingRouting::DeltaSteppingRouting() { }
+
+DeltaSteppingRouting::~DeltaSteppingRouting() { }
+
+void DeltaSteppingRouting::initialize(int stage)
+{
+    IdealRoutingBase::initialize(stage);
+
+    if (stage == INITSTAGE_LOCAL) {
+        delta = par("delta");
+        if (delta < 0)
+            throw cRuntimeError("DeltaSteppingRouting: delta must not be negative, got %g", delta);
+    }
+}
+
+void DeltaSteppingRouting::calculateFirstHops(const CsrGraph& graph, int hostIndex, std::vector<int>& firstHopEdges)
+{
+    // 在共享拓扑的邻接数组（CSR）上用线程池并行计算单源最短路径
+    double bucketWidth = delta > 0 ? delta : graph.getMeanEdgeWeight();
+    CsrGraph::ShortestPathTree tree;
+    graph.calculateDeltaSteppingShortestPathsFrom(hostIndex, bucketWidth, topologyManager->getWorkerPool(), tree);
+
+    // 每个目的节点的第一条边在松弛时已随距离一起传播
+    firstHopEdges = std::move(tree.firstEdge);
+}
+
+} // namespace leolab
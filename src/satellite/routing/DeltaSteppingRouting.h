@@ -0,0 +1,53 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+
+#ifndef SATELLITE_ROUTING_DELTASTEPPINGROUTING_H_
+#define SATELLITE_ROUTING_DELTASTEPPINGROUTING_H_
+
+#include "IdealRoutingBase.h"
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+/**
+ * 基于 delta-stepping 的路由模块。
+ * - 继承 IdealRoutingBase（计时器、共享拓扑与路由表写入的公共逻辑）
+ * - 节点按距离放入宽度为 delta 的桶中，同一个桶内所有节点的出边在 TopologyManager 的
+ *   工作线程池上并行松弛，结果与线程数无关
+ * - delta 越小越接近 Dijkstra（每个桶的节点少、并行度低），越大越接近 Bellman-Ford（重复松弛多）
+ */
+class DeltaSteppingRouting : public IdealRoutingBase
+{
+  protected:
+    // ---------- 算法参数 ----------
+    double delta = 0;               // 桶宽度，0 表示取已启用边的平均权重
+
+  protected:
+    virtual void initialize(int stage) override;
+    // 计算本节点到每个目的节点的第一条边
+    virtual void calculateFirstHops(const CsrGraph& graph, int hostIndex, std::vector<int>& firstHopEdges) override;
+    virtual const char *getAlgorithmName() const override { return "Delta-stepping"; }
+
+  public:
+    DeltaSteppingRouting();
+    virtual ~DeltaSteppingRouting();
+};
+
+} // namespace leolab
+
+#endif /* SATELLITE_ROUTING_DELTASTEPPINGROUTING_H_ */
@@ -0,0 +1,429 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "IdealRoutingBase.h"
+#include <inet/common/ModuleAccess.h>
+#include <inet/networklayer/ipv4/Ipv4InterfaceData.h>
+#include <inet/networklayer/ipv4/Ipv4Route.h>
+#include <inet/networklayer/contract/IRoutingTable.h>   // 使用接口而非实现类
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+IdealRoutingBase::IdealRoutingBase() { }
+
+IdealRoutingBase::~IdealRoutingBase()
+{
+    // 若仿真提前结束，计时器仍可能存在
+    cancelAndDelete(updateTimer);
+    cancelAndDelete(holdoffTimer);
+    delete multipathForwarding;     // 析构时自动从 Ipv4 注销
+}
+
+void IdealRoutingBase::initialize(int stage)
+{
+    if (stage == INITSTAGE_LOCAL) {
+        // 获取宿主节点
+        host = getContainingNode(this);
+        if (!host)
+            throw cRuntimeError("%s: cannot find containing node", getClassName());
+
+        // 通过 NED 参数绑定接口表和路由表模块（与 INET 默认参数名保持一致）
+        ift.reference(this, "interfaceTableModule", true);
+        rt.reference(this, "routingTableModule", true);
+        forwardingTable = dynamic_cast<LeoRoutingTable *>(rt.get());
+        topologyManager.reference(this, "topologyManagerModule", false);
+        addressDirectory.reference(this, "addressDirectoryModule", false);
+
+        updateInterval = par("updateInterval");
+        holdoffTime = par("holdoffTime");
+        updateOnTopologyChange = par("updateOnTopologyChange");
+        aggregatePrefixLength = par("aggregatePrefixLength");
+        if (aggregatePrefixLength < 0 || aggregatePrefixLength > 32)
+            throw cRuntimeError("%s: aggregatePrefixLength must be in 0..32", getClassName());
+        if (updateInterval < SIMTIME_ZERO || holdoffTime < SIMTIME_ZERO)
+            throw cRuntimeError("%s: updateInterval and holdoffTime must not be negative", getClassName());
+
+        ecmp = par("ecmp");
+        if (ecmp) {
+            networkProtocol.reference(this, "networkProtocolModule", true);
+            // 以宿主节点的模块 ID 作为哈希盐值，各节点对同一条流独立选择
+            multipathForwarding = new MultipathForwarding(rt.get(), host->getId());
+        }
+
+        // 拓扑或地址目录变化时延迟 holdoffTime 更新，窗口内的多次变化只触发一次计算
+        if (updateOnTopologyChange) {
+            holdoffTimer = new cMessage("IdealRouting-holdoff");
+            if (topologyManager.get() != nullptr)
+                topologyManager->subscribe(TopologyManager::topologyChangedSignal, this);
+            if (addressDirectory.get() != nullptr)
+                addressDirectory->subscribe(AddressDirectory::directoryChangedSignal, this);
+        }
+
+        // 创建并安排更新计时器（仿真时间 0 立即触发一次，之后按 updateInterval 周期触发）
+        updateTimer = new cMessage("IdealRouting-update");
+        scheduleAt(simTime(), updateTimer);
+    }
+    else if (stage == INITSTAGE_ROUTING_PROTOCOLS) {
+        // 在 Ipv4 上挂载多路径转发钩子（路由查表之前选择出接口）
+        if (multipathForwarding)
+            networkProtocol->registerHook(0, multipathForwarding);
+    }
+}
+
+void IdealRoutingBase::handleMessage(cMessage *msg)
+{
+    if (msg == updateTimer) {
+        updateRoutingTable();
+
+        // 未配置周期更新时，计时器只用一次，安全删除
+        if (updateInterval > SIMTIME_ZERO)
+            scheduleAfter(updateInterval, updateTimer);
+        else {
+            delete updateTimer;
+            updateTimer = nullptr;
+        }
+    }
+    else if (msg == holdoffTimer)
+        updateRoutingTable();
+    else
+        throw cRuntimeError("%s: unexpected message %s", getClassName(), msg->getName());
+}
+
+void IdealRoutingBase::finish()
+{
+    cancelAndDelete(updateTimer);
+    updateTimer = nullptr;
+    cancelAndDelete(holdoffTimer);
+    holdoffTimer = nullptr;
+
+    recordScalar("routesAdded", numRoutesAdded);
+    recordScalar("routesChanged", numRoutesChanged);
+    recordScalar("routesDeleted", numRoutesDeleted);
+    if (multipathForwarding)
+        recordScalar("multipathForwarded", multipathForwarding->getNumForwarded());
+}
+
+void IdealRoutingBase::receiveSignal(cComponent *source, simsignal_t signalID, intval_t value, cObject *details)
+{
+    Enter_Method("%s", cComponent::getSignalName(signalID));
+
+    // 已有待执行的更新时，本次变化会一并处理
+    if ((signalID == TopologyManager::topologyChangedSignal || signalID == AddressDirectory::directoryChangedSignal) && holdoffTimer && !holdoffTimer->isScheduled())
+        scheduleAfter(holdoffTime, holdoffTimer);
+}
+
+void IdealRoutingBase::findDestinationNetwork(cModule *dstMod, Ipv4Address& network, Ipv4Address& netmask)
+{
+    // 0) 目的节点在地址目录中时直接使用缓存的条目
+    if (addressDirectory.get() != nullptr) {
+        if (const AddressDirectory::Entry *entry = addressDirectory->findEntry(dstMod)) {
+            network = entry->network;
+            netmask = entry->netmask;
+            return;
+        }
+    }
+
+    // 1) 取得该节点的 IInterfaceTable（默认名字为 "interfaceTable"）
+    IInterfaceTable *ifTable = check_and_cast<IInterfaceTable*>(dstMod->getSubmodule("interfaceTable"));
+    if (!ifTable) {
+        throw cRuntimeError("Destination node %s 没有 interfaceTable", dstMod->getFullPath().c_str());
+    }
+
+    // 2) 在 InterfaceTable 中遍历，寻找 eth4 的接口
+    NetworkInterface *ifData = ifTable->findInterfaceByName("eth4");
+
+    // 3) 错误处理
+    if (!ifData || ifData->getIpv4Address().isUnspecified()) {
+        throw cRuntimeError("Destination node %s 没有 eth4 接口或该接口未配置 IP 地址", dstMod->getFullPath().c_str());
+    }
+
+    netmask = ifData->getIpv4Netmask();
+    network = ifData->getIpv4Address().doAnd(netmask);
+}
+
+void IdealRoutingBase::calculateFirstHops(const CsrGraph& graph, int hostIndex, std::vector<int>& firstHopEdges)
+{
+    throw cRuntimeError("%s: topology based route computation is not implemented", getClassName());
+}
+
+void IdealRoutingBase::updateRoutingTable()
+{
+    if (topologyManager.get() == nullptr)
+        throw cRuntimeError("%s: parameter topologyManagerModule is empty", getClassName());
+
+    // 共享拓扑和地址目录的版本都未变化时，已安装的路由仍然有效
+    int directoryVersion = addressDirectory.get() != nullptr ? addressDirectory->getVersion() : -1;
+    if (topologyManager->getEpoch() == topologyEpoch && directoryVersion == addressDirectoryVersion)
+        return;
+    addressDirectoryVersion = directoryVersion;
+
+    // 从网络级拓扑服务获取共享拓扑快照（只读）
+    const leolab::Topology *topo = topologyManager->getTopology();
+    topologyEpoch = topologyManager->getEpoch();
+
+    // 找到本节点在拓扑邻接数组（CSR）中的索引
+    const CsrGraph& graph = topo->getCsrGraph();
+    int hostIndex = graph.findNode(host->getId());
+    if (hostIndex == -1) {
+        EV_INFO << "Warning: host not found in topology, aborting routing update.\n";
+        return;
+    }
+
+    // 网络被分割时，其他连通分量中的目的节点一定不可达，不必查看其最短路径；
+    // 本节点孤立（或被禁用）时不必计算最短路径
+    const std::vector<int> *components = topologyManager->isPartitioned() ? &topologyManager->getComponents() : nullptr;
+    int hostComponent = components ? (*components)[hostIndex] : 0;
+    bool isolated = components && (hostComponent == -1 || std::count(components->begin(), components->end(), hostComponent) == 1);
+
+    // 由具体算法计算每个目的节点的第一条边
+    std::vector<int> firstHopEdges;
+    if (isolated)
+        firstHopEdges.assign(graph.getNumNodes(), -1);
+    else
+        calculateFirstHops(graph, hostIndex, firstHopEdges);
+
+    // 获取直连邻居cModule->eth的映射关系
+    // key: 远端模块cModule指针，value: 本节点对应的NetworkInterface*
+    std::unordered_map<cModule*, NetworkInterface*> neighborMap;
+    for (int i = 0; i < ift->getNumInterfaces(); ++i) {
+        NetworkInterface *intf = ift->getInterface(i);
+        const char *ifName = intf->getInterfaceName();   // 形如 "eth0"
+        // 判断接口名前缀是否为eth
+        if (strncmp(ifName, "eth", 3) == 0) {
+            int idx = -1;
+            // 判断接口索引是否在[0,3]范围内
+            if (sscanf(ifName, "eth%d", &idx) == 1 && idx >= 0 && idx <= 3) {
+                cGate *gate = intf->getParentModule()->gate("ethg$o", idx);
+                if (gate && gate->isConnected()) {
+                    cGate *remoteGate = gate->getNextGate();
+                    if (remoteGate) {
+                        cModule *remoteMod = remoteGate->getOwnerModule();
+                        neighborMap[remoteMod] = intf;   // 记录映射关系
+                    }
+                }
+            }
+        }
+    }
+
+    // 启用等价多路径时，由本节点的最短路径树得到到每个目的节点所有等价的第一条边
+    // （按本节点出边编号的位掩码），不需要其他节点的最短路径树
+    std::vector<uint64_t> equalCostEdgeMasks;
+    if (multipathForwarding && !isolated) {
+        CsrGraph::ShortestPathTree tree;
+        graph.calculateShortestPathsFrom(hostIndex, tree);
+        graph.calculateEqualCostFirstEdges(tree, equalCostEdgeMasks);
+    }
+    MultipathForwarding::GroupMap multipathGroups;
+
+    // 计算期望的路由
+    RouteMap wantedRoutes;
+    std::set<Ipv4Address> unreachableNetworks;
+    for (int i = 0; i < graph.getNumNodes(); ++i) {
+        if (i == hostIndex) continue;   // 跳过自己
+
+        cModule *dstMod = getSimulation()->getModule(graph.getModuleId(i));
+
+        // 取得目的节点 eth4 接口的子网
+        Ipv4Address destNetwork, destMask;
+        findDestinationNetwork(dstMod, destNetwork, destMask);
+
+        // 跳过不可达的目的节点（同时记录下来，聚合路由不能覆盖它）
+        int firstEdge = !components || (*components)[i] == hostComponent ? firstHopEdges[i] : -1;
+        if (firstEdge == -1) {
+            EV_WARN << "Destination node " << dstMod->getFullPath() << " is unreachable" << endl;
+            unreachableNetworks.insert(destNetwork);
+            continue;
+        }
+
+        // 最短路径的第一条边即指向下一跳节点，若其为 eth[0]~eth[3] 直接相连的邻居，则使用对应的接口
+        cModule *nextHopMod = getSimulation()->getModule(graph.getModuleId(graph.getEdgeDestination(firstEdge)));
+        auto it = neighborMap.find(nextHopMod);
+        if (it == neighborMap.end()) {
+            throw cRuntimeError("Output interface error!\n");
+        }
+
+        wantedRoutes[std::make_pair(destNetwork, destMask)] = it->second;
+
+        // 等价的出接口（去重并按接口 ID 排序，使流哈希的结果与边的顺序无关）
+        if (!equalCostEdgeMasks.empty()) {
+            std::map<int, NetworkInterface *> interfaces;
+            for (int j = 0; j < graph.getNumOutEdges(hostIndex); j++) {
+                if (!(equalCostEdgeMasks[i] & (uint64_t(1) << j)))
+                    continue;
+                int edge = graph.getFirstOutEdge(hostIndex) + j;
+                auto neighbor = neighborMap.find(getSimulation()->getModule(graph.getModuleId(graph.getEdgeDestination(edge))));
+                if (neighbor != neighborMap.end())
+                    interfaces[neighbor->second->getInterfaceId()] = neighbor->second;
+            }
+            if (interfaces.size() > 1) {
+                auto& group = multipathGroups[std::make_pair(destNetwork, destMask)];
+                for (auto& entry : interfaces)
+                    group.push_back(entry.second);
+            }
+        }
+    }
+
+    if (multipathForwarding)
+        installMultipathGroups(multipathGroups);
+    installRoutes(wantedRoutes, unreachableNetworks);
+}
+
+void IdealRoutingBase::installMultipathGroups(MultipathForwarding::GroupMap& groups)
+{
+    if (!multipathForwarding)
+        throw cRuntimeError("%s: installing multipath groups requires ecmp = true", getClassName());
+    int numGroups = groups.size();
+    multipathForwarding->setGroups(groups);
+    EV_INFO << getAlgorithmName() << " 等价多路径：" << numGroups << " 个目的子网有多个出接口。" << endl;
+}
+
+void IdealRoutingBase::aggregateRoutes(RouteMap& routes, const std::set<Ipv4Address>& unreachableNetworks) const
+{
+    Ipv4Address aggregateMask = Ipv4Address::makeNetmask(aggregatePrefixLength);
+
+    // 按聚合前缀分组（比聚合前缀更长的路由才参与）
+    std::map<Ipv4Address, std::vector<RouteMap::iterator>> groups;
+    for (auto it = routes.begin(); it != routes.end(); ++it)
+        if (it->first.second.getNetmaskLength() > aggregatePrefixLength)
+            groups[it->first.first.doAnd(aggregateMask)].push_back(it);
+
+    // 含不可达子网的前缀不聚合，否则发往该子网的分组会沿聚合路由转发
+    for (const Ipv4Address& network : unreachableNetworks)
+        groups.erase(network.doAnd(aggregateMask));
+
+    for (auto& group : groups) {
+        auto aggregateKey = std::make_pair(group.first, aggregateMask);
+        if (group.second.size() < 2 || routes.find(aggregateKey) != routes.end())
+            continue;
+
+        // 以组内最多使用的出接口作为聚合路由，其余条目作为更长前缀的例外保留
+        std::map<int, std::pair<int, NetworkInterface *>> interfaceCounts;    // 接口 ID -> (条目数, 接口)
+        for (auto it : group.second) {
+            auto& count = interfaceCounts[it->second->getInterfaceId()];
+            count.first++;
+            count.second = it->second;
+        }
+        NetworkInterface *aggregateInterface = nullptr;
+        int maxCount = 0;
+        for (auto& entry : interfaceCounts) {
+            if (entry.second.first > maxCount) {
+                maxCount = entry.second.first;
+                aggregateInterface = entry.second.second;
+            }
+        }
+
+        for (auto it : group.second)
+            if (it->second == aggregateInterface)
+                routes.erase(it);
+        routes[aggregateKey] = aggregateInterface;
+    }
+}
+
+void IdealRoutingBase::installNextHops(RouteMap& wantedRoutes, int& added, int& changed, int& deleted)
+{
+    // 按地址目录把目的子网映射为卫星下标，没有路由的卫星对应 nullptr（删除条目）；
+    // 查找表在此处建立，之后由地址目录在条目作废时重建
+    forwardingTable->getAddressDirectory()->updateLookup();
+    std::vector<NetworkInterface *> nextHops(forwardingTable->getNumSatellites(), nullptr);
+    for (auto it = wantedRoutes.begin(); it != wantedRoutes.end(); ) {
+        int index = forwardingTable->findSatelliteIndex(it->first.first);
+        if (index == -1) {
+            ++it;
+            continue;
+        }
+        nextHops[index] = it->second;
+        it = wantedRoutes.erase(it);
+    }
+
+    // 只修改发生变化的条目
+    for (int i = 0; i < (int)nextHops.size(); ++i) {
+        NetworkInterface *installed = forwardingTable->getNextHop(i);
+        if (installed == nextHops[i])
+            continue;
+        if (installed == nullptr)
+            added++;
+        else if (nextHops[i] == nullptr)
+            deleted++;
+        else
+            changed++;
+        forwardingTable->setNextHop(i, nextHops[i]);
+    }
+}
+
+void IdealRoutingBase::installRoutes(RouteMap& wantedRoutes, const std::set<Ipv4Address>& unreachableNetworks)
+{
+    // 0) 使用扁平转发表时，先把发往各卫星的路由写入数组；
+    //    再按前缀聚合剩余的路由，减少路由条目
+    int added = 0, changed = 0, deleted = 0;
+    if (forwardingTable)
+        installNextHops(wantedRoutes, added, changed, deleted);
+    int numUnaggregated = wantedRoutes.size();
+    if (aggregatePrefixLength > 0)
+        aggregateRoutes(wantedRoutes, unreachableNetworks);
+
+    // 1) 收集本模块此前写入的路由
+    std::map<std::pair<Ipv4Address, Ipv4Address>, Ipv4Route*> installedRoutes;
+    for (int i = 0; i < rt->getNumRoutes(); ++i) {
+        Ipv4Route *route = rt->getRoute(i);
+        if (route->getSource() == this)
+            installedRoutes[std::make_pair(route->getDestination(), route->getNetmask())] = route;
+    }
+
+    // 2) 只增删改发生变化的条目，未变化的路由不触发路由表变化信号
+    for (auto& entry : installedRoutes) {
+        if (wantedRoutes.find(entry.first) == wantedRoutes.end()) {
+            rt->deleteRoute(entry.second);
+            deleted++;
+        }
+    }
+    for (auto& entry : wantedRoutes) {
+        NetworkInterface *outIf = entry.second;
+        auto it = installedRoutes.find(entry.first);
+        if (it == installedRoutes.end()) {
+            // 添加路由条目
+            Ipv4Route *route = new Ipv4Route();
+            route->setDestination(entry.first.first);
+            route->setNetmask(entry.first.second);
+            route->setInterface(outIf);
+            route->setSource(this);
+            rt->addRoute(route);
+            added++;
+        }
+        else if (it->second->getInterface() != outIf) {
+            // 原地修改路由条目的出接口
+            it->second->setInterface(outIf);
+            changed++;
+        }
+    }
+    numRoutesAdded += added;
+    numRoutesChanged += changed;
+    numRoutesDeleted += deleted;
+
+    EV_INFO << getAlgorithmName() << " 路由表已更新：新增 " << added << " 条，修改 "
+            << changed << " 条，删除 " << deleted << " 条，共 " << rt->getNumRoutes() << " 条路由";
+    if (forwardingTable)
+        EV_INFO << "和 " << forwardingTable->getNumNextHops() << " 个转发表条目";
+    if (aggregatePrefixLength > 0)
+        EV_INFO << "（" << numUnaggregated << " 个目的子网聚合为 " << wantedRoutes.size() << " 条）";
+    EV_INFO << "。" << endl;
+}
+
+} // namespace leolab
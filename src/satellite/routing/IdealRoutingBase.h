@@ -0,0 +1,141 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef SATELLITE_ROUTING_IDEALROUTINGBASE_H_
+#define SATELLITE_ROUTING_IDEALROUTINGBASE_H_
+
+#include "TopologyManager.h"
+#include "AddressDirectory.h"
+#include "LeoRoutingTable.h"
+#include "MultipathForwarding.h"
+#include <map>
+#include <set>
+#include <omnetpp.h>
+#include "inet/common/INETDefs.h"
+#include "inet/networklayer/ipv4/IIpv4RoutingTable.h"
+#include "inet/networklayer/contract/IInterfaceTable.h"
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+/**
+ * 理想路由模块的公共基类（Dijkstra、Bellman-Ford 等）。
+ * - 负责计时器、共享拓扑的获取以及路由表的写入
+ * - 子类只需给出本节点到每个目的节点最短路径的第一条 CSR 边；
+ *   不依赖拓扑的子类可以重写 updateRoutingTable()，直接调用 installRoutes()
+ * - 更新时间：仿真开始时一次；可选周期更新（updateInterval）和拓扑变化触发的更新
+ *   （updateOnTopologyChange，holdoffTime 内的多次变化合并为一次；地址目录有条目作废时同样触发）
+ * - 只对比并增删改发生变化的路由条目，避免整表删除重建
+ * - 目的节点的 eth4 子网优先从网络级地址目录（AddressDirectory）读取，不再逐个访问目的节点的接口表
+ * - 宿主的路由表为扁平转发表（LeoRoutingTable）时，发往各卫星的路由写入其按卫星下标索引的数组，
+ *   不再创建路由条目；地址规划之外的路由仍写入路由列表（只有这部分参与聚合）
+ * - 可选按前缀聚合路由（aggregatePrefixLength），配合按 (轨道面, 编号) 规划的地址使每个节点只需 O(轨道面数 + 轨道内卫星数) 条路由
+ * - 可选等价多路径转发（ecmp）：路由表中仍为每个目的子网写入一条路由，
+ *   另把所有等价的出接口交给挂在 Ipv4 上的 MultipathForwarding，按流哈希分担负载
+ */
+class IdealRoutingBase : public cSimpleModule, public cListener
+{
+  protected:
+    // 期望的路由：(目的子网, 子网掩码) -> 出接口
+    typedef std::map<std::pair<Ipv4Address, Ipv4Address>, NetworkInterface *> RouteMap;
+
+  protected:
+    // ---------- 计时器 ----------
+    cMessage *updateTimer = nullptr;    // 启动及周期更新的自触发消息
+    cMessage *holdoffTimer = nullptr;   // 拓扑变化后延迟更新的自触发消息
+    simtime_t updateInterval;           // 周期更新间隔，0 表示不周期更新
+    simtime_t holdoffTime;              // 拓扑变化到更新路由之间的合并窗口
+    bool updateOnTopologyChange = false;    // 是否在拓扑变化时更新路由
+
+    // ---------- 宿主信息 ----------
+    cModule *host = nullptr;            // 拥有本模块的节点（router / host）
+
+    ModuleRefByPar<IIpv4RoutingTable> rt;   // 宿主的 IPv4 路由表
+    ModuleRefByPar<IInterfaceTable> ift;    // 宿主的接口表
+    LeoRoutingTable *forwardingTable = nullptr; // rt 为扁平转发表时非空
+
+    // ---------- 共享拓扑 ----------
+    ModuleRefByPar<TopologyManager> topologyManager;    // 网络级拓扑服务
+    int topologyEpoch = -1;             // 上次计算路由时使用的拓扑版本号
+
+    // ---------- 地址目录 ----------
+    ModuleRefByPar<AddressDirectory> addressDirectory;  // 网络级接口/地址目录，可选
+    int addressDirectoryVersion = -1;   // 上次计算路由时使用的目录版本号
+
+    // ---------- 路由聚合 ----------
+    int aggregatePrefixLength = 0;      // 聚合前缀长度，0 表示不聚合
+
+    // ---------- 等价多路径 ----------
+    bool ecmp = false;                  // 是否启用等价多路径转发
+    ModuleRefByPar<INetfilter> networkProtocol;     // 挂载多路径转发钩子的 Ipv4 模块
+    MultipathForwarding *multipathForwarding = nullptr; // 多路径转发钩子，仅在 ecmp 时创建
+
+    // ---------- 统计 ----------
+    int numRoutesAdded = 0;             // 累计新增的路由条目数
+    int numRoutesChanged = 0;           // 累计修改的路由条目数
+    int numRoutesDeleted = 0;           // 累计删除的路由条目数
+
+  protected:
+    // OMNeT++ 生命周期
+    virtual int numInitStages() const override { return NUM_INIT_STAGES; }
+    virtual void initialize(int stage) override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;    // 释放计时器
+
+    // cListener 接口，接收拓扑和地址目录的变化通知
+    virtual void receiveSignal(cComponent *source, simsignal_t signalID, intval_t value, cObject *details) override;
+
+    // 抽取拓扑、计算路径并把变化写入路由表
+    virtual void updateRoutingTable();
+
+    // 替换多路径转发使用的等价出接口组（只含出接口多于一个的目的子网）
+    virtual void installMultipathGroups(MultipathForwarding::GroupMap& groups);
+
+    // 按 aggregatePrefixLength 聚合后与本模块已写入的路由对比，只增删改发生变化的条目；
+    // unreachableNetworks 为没有路由的目的子网，聚合路由不会覆盖它们
+    virtual void installRoutes(RouteMap& wantedRoutes, const std::set<Ipv4Address>& unreachableNetworks = std::set<Ipv4Address>());
+
+    // 把地址规划内的目的子网写入扁平转发表并从 wantedRoutes 中移除，累加增删改的条目数
+    virtual void installNextHops(RouteMap& wantedRoutes, int& added, int& changed, int& deleted);
+
+    /**
+     * 把同一聚合前缀下的路由合并为一条聚合路由（出接口取组内最多的接口），
+     * 出接口不同的条目作为更长前缀的例外保留，最长前缀匹配的结果不变。
+     */
+    virtual void aggregateRoutes(RouteMap& routes, const std::set<Ipv4Address>& unreachableNetworks) const;
+
+    // 取得目的节点 eth4 接口所在的子网（优先查地址目录）
+    virtual void findDestinationNetwork(cModule *dstMod, Ipv4Address& network, Ipv4Address& netmask);
+
+    /**
+     * 计算本节点（hostIndex）到每个节点最短路径的第一条 CSR 边，
+     * 写入 firstHopEdges[目的节点索引]；本节点和不可达节点为 -1。
+     * 基于拓扑的子类必须重写（默认实现报错）。
+     */
+    virtual void calculateFirstHops(const CsrGraph& graph, int hostIndex, std::vector<int>& firstHopEdges);
+
+    // 日志中使用的算法名称
+    virtual const char *getAlgorithmName() const = 0;
+
+  public:
+    IdealRoutingBase();
+    virtual ~IdealRoutingBase();
+};
+
+} // namespace leolab
+
+#endif /* SATELLITE_ROUTING_IDEALROUTINGBASE_H_ */
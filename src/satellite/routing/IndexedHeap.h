@@ -0,0 +1,144 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef SATELLITE_ROUTING_INDEXEDHEAP_H_
+#define SATELLITE_ROUTING_INDEXEDHEAP_H_
+
+#include <vector>
+
+namespace leolab {
+
+/**
+ * Indexed d-ary min-heap over the keys 0..n-1, used as the priority queue of
+ * the shortest path algorithms. Every key is in the heap at most once, and
+ * its priority can be lowered in place (decrease-key), so a search performs
+ * O(N) pushes and pops and O(E) decrease-keys, each in O(log_D N).
+ *
+ * Ties are broken by key, so the pop order only depends on the priorities.
+ */
+template <int D = 4>
+class IndexedHeap
+{
+  protected:
+    std::vector<int> heap;          // keys in heap order
+    std::vector<int> position;      // position of each key in heap[], -1 if not in the heap
+    std::vector<double> priority;   // priority of each key
+
+  protected:
+    bool less(int a, int b) const {
+        return priority[a] < priority[b] || (priority[a] == priority[b] && a < b);
+    }
+
+    void place(int pos, int key) {
+        heap[pos] = key;
+        position[key] = pos;
+    }
+
+    void siftUp(int pos) {
+        int key = heap[pos];
+        while (pos > 0) {
+            int parent = (pos - 1) / D;
+            if (!less(key, heap[parent]))
+                break;
+            place(pos, heap[parent]);
+            pos = parent;
+        }
+        place(pos, key);
+    }
+
+    void siftDown(int pos) {
+        int key = heap[pos];
+        int size = heap.size();
+        while (true) {
+            int first = pos * D + 1;
+            if (first >= size)
+                break;
+            int last = first + D < size ? first + D : size;
+            int best = first;
+            for (int child = first + 1; child < last; child++)
+                if (less(heap[child], heap[best]))
+                    best = child;
+            if (!less(heap[best], key))
+                break;
+            place(pos, heap[best]);
+            pos = best;
+        }
+        place(pos, key);
+    }
+
+  public:
+    /**
+     * Empties the heap and prepares it for the keys 0..n-1.
+     */
+    void reset(int n) {
+        heap.clear();
+        heap.reserve(n);
+        position.assign(n, -1);
+        priority.resize(n);
+    }
+
+    bool isEmpty() const { return heap.empty(); }
+    int getSize() const { return heap.size(); }
+    bool contains(int key) const { return position[key] != -1; }
+
+    /**
+     * Inserts the key, or lowers its priority if it is already in the heap.
+     * Raising the priority of a key already in the heap is not supported.
+     */
+    void push(int key, double prio) {
+        priority[key] = prio;
+        if (position[key] == -1) {
+            heap.push_back(key);
+            position[key] = heap.size() - 1;
+        }
+        siftUp(position[key]);
+    }
+
+    /**
+     * Removes the key with the lowest priority and returns it.
+     */
+    int pop() {
+        int top = heap[0];
+        position[top] = -1;
+        int last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            place(0, last);
+            siftDown(0);
+        }
+        return top;
+    }
+
+    /**
+     * Removes the given key from the heap, if present.
+     */
+    void remove(int key) {
+        int pos = position[key];
+        if (pos == -1)
+            return;
+        position[key] = -1;
+        int last = heap.back();
+        heap.pop_back();
+        if (pos < (int)heap.size()) {
+            place(pos, last);
+            siftUp(pos);
+            siftDown(position[last]);
+        }
+    }
+};
+
+} // namespace leolab
+
+#endif /* SATELLITE_ROUTING_INDEXEDHEAP_H_ */
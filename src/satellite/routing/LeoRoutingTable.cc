@@ -0,0 +1,111 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "LeoRoutingTable.h"
+#include "inet/common/ModuleAccess.h"
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+Define_Module(LeoRoutingTable);
+
+LeoRoutingTable::LeoRoutingTable() { }
+
+LeoRoutingTable::~LeoRoutingTable()
+{
+    for (Ipv4Route *route : nextHopRoutes)
+        delete route;
+}
+
+void LeoRoutingTable::initialize(int stage)
+{
+    Ipv4RoutingTable::initialize(stage);
+
+    // 地址目录在 INITSTAGE_LOCAL 中初始化，之后才能查询
+    if (stage == INITSTAGE_NETWORK_LAYER) {
+        addressDirectory = getModuleFromPar<AddressDirectory>(par("addressDirectoryModule"), this);
+        nextHops.assign(addressDirectory->getNumEntries(), 0);
+        ownIndex = addressDirectory->findIndex(getContainingNode(this));
+        if (ownIndex == -1)
+            throw cRuntimeError("LeoRoutingTable: %s is not a satellite of the address directory", getContainingNode(this)->getFullPath().c_str());
+    }
+}
+
+void LeoRoutingTable::finish()
+{
+    Ipv4RoutingTable::finish();
+    recordScalar("fastLookups", numFastLookups);
+    recordScalar("nextHops", numNextHops);
+}
+
+void LeoRoutingTable::setNextHop(int index, NetworkInterface *networkInterface)
+{
+    Enter_Method("setNextHop");
+    if (index < 0 || index >= (int)nextHops.size())
+        throw cRuntimeError("LeoRoutingTable: satellite index %d out of range 0..%d", index, (int)nextHops.size() - 1);
+
+    uint8_t slot = 0;
+    if (networkInterface != nullptr) {
+        // 查找或创建该出接口的共享路由
+        while (slot < nextHopRoutes.size() && nextHopRoutes[slot]->getInterface() != networkInterface)
+            slot++;
+        if (slot == nextHopRoutes.size()) {
+            if (slot == UINT8_MAX)
+                throw cRuntimeError("LeoRoutingTable: more than %d output interfaces", UINT8_MAX - 1);
+            Ipv4Route *route = new Ipv4Route();
+            route->setInterface(networkInterface);
+            route->setSourceType(IRoute::MANUAL);
+            route->setSource(this);
+            nextHopRoutes.push_back(route);
+        }
+        slot++;
+    }
+
+    if ((nextHops[index] != 0) != (slot != 0))
+        numNextHops += slot != 0 ? 1 : -1;
+    nextHops[index] = slot;
+}
+
+NetworkInterface *LeoRoutingTable::getNextHop(int index) const
+{
+    if (index < 0 || index >= (int)nextHops.size() || nextHops[index] == 0)
+        return nullptr;
+    return nextHopRoutes[nextHops[index] - 1]->getInterface();
+}
+
+Ipv4Route *LeoRoutingTable::findBestMatchingRoute(const Ipv4Address& dest) const
+{
+    // 本卫星自己的子网（接入的地面主机）由路由列表中的接口路由处理
+    int prefixLength = 0;
+    int index = addressDirectory->findIndex(dest, &prefixLength);
+    if (index == -1 || index == ownIndex || nextHops[index] == 0)
+        return Ipv4RoutingTable::findBestMatchingRoute(dest);
+
+    // 路由列表按前缀由长到短排列：只需查看比卫星子网更长的前缀，其中有匹配的路由时按最长前缀匹配
+    for (int i = 0; i < getNumRoutes(); i++) {
+        const Ipv4Route *route = getRoute(i);
+        if (route->getNetmask().getNetmaskLength() <= prefixLength)
+            break;
+        if (Ipv4Address::maskedAddrAreEqual(dest, route->getDestination(), route->getNetmask()))
+            return Ipv4RoutingTable::findBestMatchingRoute(dest);
+    }
+
+    numFastLookups++;
+    return nextHopRoutes[nextHops[index] - 1];
+}
+
+} // namespace leolab
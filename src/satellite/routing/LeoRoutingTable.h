@@ -0,0 +1,102 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef SATELLITE_ROUTING_LEOROUTINGTABLE_H_
+#define SATELLITE_ROUTING_LEOROUTINGTABLE_H_
+
+#include <vector>
+#include <omnetpp.h>
+#include "inet/common/INETDefs.h"
+#include "inet/networklayer/ipv4/Ipv4RoutingTable.h"
+#include "AddressDirectory.h"
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+/**
+ * 卫星节点的扁平转发表，实现 IIpv4RoutingTable（继承 INET 的 Ipv4RoutingTable）。
+ * - 目的地址经网络级地址目录（AddressDirectory）按地址规划映射为卫星下标，
+ *   再在按卫星下标索引的数组中查出出接口，每次查找 O(1)，每个目的卫星只占 1 字节
+ * - 数组中的值是出接口路由的编号：每个出接口只有一条共享的 Ipv4Route，不进入路由列表
+ * - 本卫星自己的 eth4 子网、地址规划之外的目的地址、没有数组条目的目的卫星，
+ *   以及路由列表中有比卫星子网更长的匹配前缀（如主机路由）的目的地址，仍按 Ipv4RoutingTable 的路由列表做最长前缀匹配
+ * - 查找只读取地址目录已建立的查找表，不会触发重建或报错
+ * - 由理想路由模块（IdealRoutingBase）通过 setNextHop() 写入，不再为每个目的子网创建路由条目
+ */
+class LeoRoutingTable : public Ipv4RoutingTable
+{
+  protected:
+    // ---------- 地址规划 ----------
+    AddressDirectory *addressDirectory = nullptr;   // 网络级接口/地址目录
+    int ownIndex = -1;                  // 本卫星在目录中的下标
+
+    // ---------- 扁平转发表 ----------
+    std::vector<uint8_t> nextHops;      // 按卫星下标索引：nextHopRoutes 中的编号 + 1，0 表示没有条目
+    std::vector<Ipv4Route *> nextHopRoutes; // 每个出接口一条路由，由本模块持有
+    int numNextHops = 0;                // 数组中的条目数
+
+    // ---------- 统计 ----------
+    mutable long numFastLookups = 0;    // 由数组直接得到结果的查找次数
+
+  protected:
+    virtual void initialize(int stage) override;
+    virtual void finish() override;
+
+  public:
+    LeoRoutingTable();
+    virtual ~LeoRoutingTable();
+
+    /**
+     * 返回目的地址所属卫星的下标（按地址规划），不在规划内时返回 -1。
+     */
+    int findSatelliteIndex(const Ipv4Address& address) const { return addressDirectory->findIndex(address); }
+
+    /**
+     * 返回目的地址所用的地址目录。
+     */
+    AddressDirectory *getAddressDirectory() const { return addressDirectory; }
+
+    /**
+     * 返回目录中的卫星数，即数组的大小。
+     */
+    int getNumSatellites() const { return nextHops.size(); }
+
+    /**
+     * 设置发往下标为 index 的卫星（及接入它的地面主机）的出接口，nullptr 表示删除条目。
+     */
+    void setNextHop(int index, NetworkInterface *networkInterface);
+
+    /**
+     * 返回发往下标为 index 的卫星的出接口，没有条目时返回 nullptr。
+     */
+    NetworkInterface *getNextHop(int index) const;
+
+    /**
+     * 返回数组中的条目数。
+     */
+    int getNumNextHops() const { return numNextHops; }
+
+    /**
+     * 目的地址在地址规划内、有数组条目且路由列表中没有更长的匹配前缀时直接返回该出接口的路由，
+     * 否则按路由列表做最长前缀匹配。
+     */
+    virtual Ipv4Route *findBestMatchingRoute(const Ipv4Address& dest) const override;
+};
+
+} // namespace leolab
+
+#endif /* SATELLITE_ROUTING_LEOROUTINGTABLE_H_ */
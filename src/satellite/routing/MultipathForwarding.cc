@@ -0,0 +1,94 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+
+#include "MultipathForwarding.h"
+#include <set>
+#include "inet/common/packet/Packet.h"
+#include "inet/networklayer/common/InterfaceTag_m.h"
+#include "inet/networklayer/common/NextHopAddressTag_m.h"
+#include "inet/networklayer/ipv4/Ipv4Header_m.h"
+#include "inet/transportlayer/udp/UdpHeader_m.h"
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+void MultipathForwarding::setGroups(GroupMap& newGroups)
+{
+    groups.swap(newGroups);
+    newGroups.clear();
+
+    // 查找时从最长的掩码开始，实现最长前缀匹配
+    std::set<Ipv4Address> masks;
+    for (auto& group : groups)
+        masks.insert(group.first.second);
+    netmasks.assign(masks.rbegin(), masks.rend());
+}
+
+uint32_t MultipathForwarding::hashFlow(uint32_t salt, uint32_t srcAddress, uint32_t destAddress, int protocol, int srcPort, int destPort)
+{
+    // 64 位混合（splitmix64 的终结步骤），各字段和盐值的每一位都影响结果
+    uint64_t h = ((uint64_t)srcAddress << 32) | destAddress;
+    h ^= ((uint64_t)(uint16_t)srcPort << 32 | (uint64_t)(uint16_t)destPort << 16 | (uint8_t)protocol) * 0x9e3779b97f4a7c15ull;
+    h ^= ((uint64_t)salt + 1) * 0xd6e8feb86659fd93ull;
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return (uint32_t)h;
+}
+
+void MultipathForwarding::selectInterface(Packet *datagram)
+{
+    if (groups.empty() || datagram->findTag<InterfaceReq>() != nullptr)
+        return;     // 没有多路径组，或出接口已由上层指定
+
+    const auto& header = datagram->peekAtFront<Ipv4Header>();
+    Ipv4Address destAddress = header->getDestAddress();
+    if (destAddress.isMulticast() || destAddress.isLimitedBroadcastAddress() || rt->isLocalAddress(destAddress))
+        return;
+
+    // 最长前缀匹配的多路径组
+    const std::vector<NetworkInterface *> *interfaces = nullptr;
+    for (const Ipv4Address& netmask : netmasks) {
+        auto it = groups.find(std::make_pair(destAddress.doAnd(netmask), netmask));
+        if (it != groups.end()) {
+            interfaces = &it->second;
+            break;
+        }
+    }
+    if (interfaces == nullptr)
+        return;
+
+    // 未分片的 UDP 分组把端口计入流标识，分片只能按地址和协议区分
+    int srcPort = 0, destPort = 0;
+    if (header->getProtocolId() == IP_PROT_UDP && header->getFragmentOffset() == 0 && !header->getMoreFragments()) {
+        const auto& udpHeader = datagram->peekDataAt<UdpHeader>(header->getHeaderLength());
+        srcPort = udpHeader->getSrcPort();
+        destPort = udpHeader->getDestPort();
+    }
+    uint32_t hash = hashFlow(salt, header->getSrcAddress().getInt(), destAddress.getInt(), header->getProtocolId(), srcPort, destPort);
+    NetworkInterface *intf = (*interfaces)[hash % interfaces->size()];
+
+    // 指定出接口；与无网关的路由一样，下一跳地址为目的地址
+    datagram->addTagIfAbsent<InterfaceReq>()->setInterfaceId(intf->getInterfaceId());
+    datagram->addTagIfAbsent<NextHopAddressReq>()->setNextHopAddress(destAddress);
+    numForwarded++;
+}
+
+} // namespace leolab
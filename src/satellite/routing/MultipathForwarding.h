@@ -0,0 +1,81 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+
+#ifndef SATELLITE_ROUTING_MULTIPATHFORWARDING_H_
+#define SATELLITE_ROUTING_MULTIPATHFORWARDING_H_
+
+#include <map>
+#include <vector>
+#include <omnetpp.h>
+#include "inet/common/INETDefs.h"
+#include "inet/networklayer/contract/INetfilter.h"
+#include "inet/networklayer/contract/IInterfaceTable.h"
+#include "inet/networklayer/ipv4/IIpv4RoutingTable.h"
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+/**
+ * 等价多路径（ECMP）转发。
+ * - 以 netfilter 钩子的形式挂在节点的 Ipv4 模块上（PREROUTING 和 LOCALOUT）
+ * - 目的地址属于某个多路径组时，按流（源/目的地址、协议、UDP 端口）的哈希在组内选择出接口，
+ *   并通过 InterfaceReq/NextHopAddressReq 标签指定给 Ipv4，同一条流始终走同一条路径，不会乱序
+ * - 哈希混入每个节点自己的盐值，避免各跳对同一条流做出相同的选择（哈希极化），
+ *   使流量分散到全部等跳数路径上，而不只是两条维序路径
+ * - 不属于任何多路径组的分组不做处理，仍按路由表转发
+ * - 多路径组由路由模块在每次计算路由后整体替换
+ */
+class MultipathForwarding : public NetfilterBase::HookBase
+{
+  public:
+    // (目的子网, 子网掩码) -> 等价的出接口（按接口 ID 排序）
+    typedef std::map<std::pair<Ipv4Address, Ipv4Address>, std::vector<NetworkInterface *>> GroupMap;
+
+  protected:
+    IIpv4RoutingTable *rt = nullptr;    // 用于判断本地地址
+    uint32_t salt = 0;                  // 本节点的哈希盐值
+    GroupMap groups;                    // 多路径组
+    std::vector<Ipv4Address> netmasks;  // 多路径组中出现的子网掩码，从长到短
+    long numForwarded = 0;              // 经多路径组选择出接口的分组数（统计用）
+
+  protected:
+    // 为发往多路径组的分组选择出接口
+    void selectInterface(Packet *datagram);
+
+  public:
+    MultipathForwarding(IIpv4RoutingTable *rt, uint32_t salt) : rt(rt), salt(salt) { }
+
+    // 整体替换多路径组（参数内容被取走）
+    void setGroups(GroupMap& newGroups);
+    int getNumGroups() const { return groups.size(); }
+    long getNumForwarded() const { return numForwarded; }
+
+    // 流哈希：同一节点上同一条流的结果固定，不依赖随机数或指针
+    static uint32_t hashFlow(uint32_t salt, uint32_t srcAddress, uint32_t destAddress, int protocol, int srcPort, int destPort);
+
+    // INetfilter::IHook 接口
+    virtual Result datagramPreRoutingHook(Packet *datagram) override { selectInterface(datagram); return ACCEPT; }
+    virtual Result datagramForwardHook(Packet *datagram) override { return ACCEPT; }
+    virtual Result datagramPostRoutingHook(Packet *datagram) override { return ACCEPT; }
+    virtual Result datagramLocalInHook(Packet *datagram) override { return ACCEPT; }
+    virtual Result datagramLocalOutHook(Packet *datagram) override { selectInterface(datagram); return ACCEPT; }
+};
+
+} // namespace leolab
+
+#endif /* SATELLITE_ROUTING_MULTIPATHFORWARDING_H_ */
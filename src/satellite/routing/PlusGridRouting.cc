@@ -0,0 +1,124 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "PlusGridRouting.h"
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+Define_Module(PlusGridRouting);
+
+PlusGridRouting::PlusGridRouting() { }
+
+PlusGridRouting::~PlusGridRouting() { }
+
+void PlusGridRouting::initialize(int stage)
+{
+    IdealRoutingBase::initialize(stage);
+
+    if (stage == INITSTAGE_LOCAL) {
+        // 与 WalkerDeltaTopologyConfigurator 一致，从网络参数得到星座规模，idx = i * M + j
+        cModule *network = host->getParentModule();
+        int numSatellites = network->par("numSatellites");
+        numPlanes = network->par("numPlane");
+        if (numPlanes <= 0 || numSatellites % numPlanes != 0)
+            throw cRuntimeError("PlusGridRouting: %d satellites cannot be divided into %d equal parts", numSatellites, numPlanes);
+        numSlots = numSatellites / numPlanes;
+
+        if (!host->isVector() || host->getVectorSize() != numSatellites)
+            throw cRuntimeError("PlusGridRouting: host %s is not an element of a %d-satellite vector", host->getFullPath().c_str(), numSatellites);
+        plane = host->getIndex() / numSlots;
+        slot = host->getIndex() % numSlots;
+    }
+}
+
+int PlusGridRouting::getNextHopPort(int destPlane, int destSlot) const
+{
+    // 先沿轨道面方向：向右（eth1）需要 dPlane 跳，向左（eth3）需要 N - dPlane 跳
+    int dPlane = (destPlane - plane + numPlanes) % numPlanes;
+    if (dPlane != 0)
+        return dPlane <= numPlanes - dPlane ? 1 : 3;
+
+    // 已在目的轨道面：向上（eth0）需要 dSlot 跳，向下（eth2）需要 M - dSlot 跳
+    int dSlot = (destSlot - slot + numSlots) % numSlots;
+    return dSlot <= numSlots - dSlot ? 0 : 2;
+}
+
+void PlusGridRouting::getEqualCostPorts(int destPlane, int destSlot, std::vector<int>& ports) const
+{
+    // 曼哈顿距离上的每一步都可以先走任一维度；环上两侧跳数相等时两侧都是最短的
+    ports.clear();
+    int dPlane = (destPlane - plane + numPlanes) % numPlanes;
+    if (dPlane != 0) {
+        if (dPlane <= numPlanes - dPlane) ports.push_back(1);
+        if (numPlanes - dPlane <= dPlane) ports.push_back(3);
+    }
+    int dSlot = (destSlot - slot + numSlots) % numSlots;
+    if (dSlot != 0) {
+        if (dSlot <= numSlots - dSlot) ports.push_back(0);
+        if (numSlots - dSlot <= dSlot) ports.push_back(2);
+    }
+}
+
+void PlusGridRouting::updateRoutingTable()
+{
+    // eth0~eth3 对应的出接口，同时检查环面链路是否存在
+    NetworkInterface *portInterfaces[4];
+    for (int port = 0; port < 4; ++port) {
+        std::string ifName = "eth" + std::to_string(port);
+        portInterfaces[port] = ift->findInterfaceByName(ifName.c_str());
+        if (!portInterfaces[port] || !host->gate("ethg$o", port)->isConnected())
+            throw cRuntimeError("PlusGridRouting: %s has no connected %s, a +Grid torus is required", host->getFullPath().c_str(), ifName.c_str());
+    }
+
+    // 逐个目的卫星按闭式计算下一跳
+    cModule *network = host->getParentModule();
+    RouteMap wantedRoutes;
+    MultipathForwarding::GroupMap multipathGroups;
+    std::vector<int> ports;
+    for (int p = 0; p < numPlanes; ++p) {
+        for (int s = 0; s < numSlots; ++s) {
+            if (p == plane && s == slot) continue;   // 跳过自己
+
+            // 取得目的节点 eth4 接口的子网
+            cModule *dstMod = network->getSubmodule(host->getName(), p * numSlots + s);
+            Ipv4Address destNetwork, destMask;
+            findDestinationNetwork(dstMod, destNetwork, destMask);
+
+            wantedRoutes[std::make_pair(destNetwork, destMask)] = portInterfaces[getNextHopPort(p, s)];
+
+            // 等价的出接口，按接口 ID 排序
+            if (multipathForwarding) {
+                getEqualCostPorts(p, s, ports);
+                if (ports.size() > 1) {
+                    std::map<int, NetworkInterface *> interfaces;
+                    for (int port : ports)
+                        interfaces[portInterfaces[port]->getInterfaceId()] = portInterfaces[port];
+                    auto& group = multipathGroups[std::make_pair(destNetwork, destMask)];
+                    for (auto& entry : interfaces)
+                        group.push_back(entry.second);
+                }
+            }
+        }
+    }
+
+    if (multipathForwarding)
+        installMultipathGroups(multipathGroups);
+    installRoutes(wantedRoutes);
+}
+
+} // namespace leolab
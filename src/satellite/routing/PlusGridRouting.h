@@ -0,0 +1,61 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef SATELLITE_ROUTING_PLUSGRIDROUTING_H_
+#define SATELLITE_ROUTING_PLUSGRIDROUTING_H_
+
+#include "IdealRoutingBase.h"
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+/**
+ * +Grid（环面）星座上的闭式最小跳数路由。
+ * - 适用于 WalkerDeltaTopologyConfigurator::createFourLinks() 构建的环面：
+ *   eth0/eth1/eth2/eth3 依次连接上（slot+1）、右（plane+1）、下（slot-1）、左（plane-1）方向的卫星
+ * - 由 (plane, slot) 编号直接算出下一跳：先沿轨道面方向（左右）走到目的轨道面，再沿轨道内方向（上下），
+ *   每个方向取环上较短的一侧，每个目的节点 O(1)，不抽取任何 Topology
+ * - 启用 ecmp 时，所有缩短距离的方向（两个维度、环上两侧等长时的两侧）都作为等价出接口
+ */
+class PlusGridRouting : public IdealRoutingBase
+{
+  protected:
+    // ---------- 星座结构 ----------
+    int numPlanes = 0;              // 轨道面数 N
+    int numSlots = 0;               // 每个轨道面的卫星数 M
+    int plane = -1;                 // 本节点所在轨道面 i
+    int slot = -1;                  // 本节点在轨道面内的编号 j
+
+  protected:
+    virtual void initialize(int stage) override;
+    virtual void updateRoutingTable() override;
+    virtual const char *getAlgorithmName() const override { return "+Grid"; }
+
+    // 从本节点到 (destPlane, destSlot) 的下一跳端口（eth0~eth3 的编号）
+    int getNextHopPort(int destPlane, int destSlot) const;
+
+    // 从本节点到 (destPlane, destSlot) 的所有最短路径的第一跳端口
+    void getEqualCostPorts(int destPlane, int destSlot, std::vector<int>& ports) const;
+
+  public:
+    PlusGridRouting();
+    virtual ~PlusGridRouting();
+};
+
+} // namespace leolab
+
+#endif /* SATELLITE_ROUTING_PLUSGRIDROUTING_H_ */
@@ -0,0 +1,157 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+
+#include "RoutingSchedule.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <omnetpp.h>
+
+namespace leolab {
+
+using namespace omnetpp;
+
+static const char MAGIC[8] = { 'L', 'E', 'O', 'R', 'T', 'S', 'C', 'H' };
+static const uint32_t VERSION = 1;
+
+uint64_t RoutingSchedule::hash(uint64_t key, const void *bytes, size_t length)
+{
+    if (key == 0)
+        key = 14695981039346656037ull;  // FNV offset basis
+    const unsigned char *p = static_cast<const unsigned char *>(bytes);
+    for (size_t i = 0; i < length; i++) {
+        key ^= p[i];
+        key *= 1099511628211ull;        // FNV prime
+    }
+    return key;
+}
+
+void RoutingSchedule::write(const char *filename, uint64_t key, int numNodes, int numSteps, double stepSize, double period, const StepFunction& fillStep)
+{
+    if (numNodes <= 0 || numSteps <= 0 || !(stepSize > 0))
+        throw cRuntimeError("RoutingSchedule: invalid dimensions (%d nodes, %d steps, step size %g)", numNodes, numSteps, stepSize);
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.numNodes = numNodes;
+    header.numSteps = numSteps;
+    header.stepSize = stepSize;
+    header.period = period;
+    header.key = key;
+
+    std::string tmpFilename = std::string(filename) + ".tmp";
+    FILE *f = fopen(tmpFilename.c_str(), "wb");
+    if (!f)
+        throw cRuntimeError("RoutingSchedule: cannot create '%s'", tmpFilename.c_str());
+
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    std::vector<Entry> table((size_t)numNodes * numNodes);
+    try {
+        for (int step = 0; ok && step < numSteps; step++) {
+            std::fill(table.begin(), table.end(), NO_ROUTE);
+            fillStep(step, table.data());
+            ok = fwrite(table.data(), sizeof(Entry), table.size(), f) == table.size();
+        }
+    }
+    catch (...) {
+        fclose(f);
+        remove(tmpFilename.c_str());
+        throw;
+    }
+    ok = fclose(f) == 0 && ok;
+    if (!ok || rename(tmpFilename.c_str(), filename) != 0) {
+        remove(tmpFilename.c_str());
+        throw cRuntimeError("RoutingSchedule: cannot write '%s'", filename);
+    }
+}
+
+bool RoutingSchedule::open(const char *filename, uint64_t key)
+{
+    close();
+
+    int fd = ::open(filename, O_RDONLY);
+    if (fd == -1)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header)) {
+        ::close(fd);
+        throw cRuntimeError("RoutingSchedule: '%s' is not a routing schedule", filename);
+    }
+    void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);   // the mapping keeps the file open
+    if (mapped == MAP_FAILED)
+        throw cRuntimeError("RoutingSchedule: cannot map '%s'", filename);
+
+    const Header *h = static_cast<const Header *>(mapped);
+    if (memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 || h->version != VERSION || h->numNodes <= 0 || h->numSteps <= 0
+            || (size_t)st.st_size != sizeof(Header) + (size_t)h->numSteps * h->numNodes * h->numNodes * sizeof(Entry)) {
+        munmap(mapped, st.st_size);
+        throw cRuntimeError("RoutingSchedule: '%s' is not a routing schedule or is truncated", filename);
+    }
+    if (h->key != key) {
+        munmap(mapped, st.st_size);
+        return false;
+    }
+
+    data = mapped;
+    size = st.st_size;
+    header = h;
+    entries = reinterpret_cast<const Entry *>(h + 1);
+    return true;
+}
+
+void RoutingSchedule::close()
+{
+    if (data != nullptr)
+        munmap(data, size);
+    data = nullptr;
+    size = 0;
+    header = nullptr;
+    entries = nullptr;
+}
+
+int RoutingSchedule::getStep(double t) const
+{
+    // a time computed by getNextStepTime() may fall a rounding error short
+    // of the boundary, it still belongs to the new step
+    double offset = header->period > 0 ? std::fmod(t, header->period) : t;
+    int step = (int)std::floor(offset / header->stepSize + 1e-9);
+    return std::min(std::max(step, 0), header->numSteps - 1);
+}
+
+double RoutingSchedule::getNextStepTime(double t) const
+{
+    double periodStart = header->period > 0 ? t - std::fmod(t, header->period) : 0;
+    int step = getStep(t);
+    if (step + 1 < header->numSteps)
+        return periodStart + (step + 1) * header->stepSize;
+    else if (header->period > 0)
+        return periodStart + header->period;
+    else
+        return INFINITY;
+}
+
+} // namespace leolab
@@ -0,0 +1,129 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+
+#ifndef SATELLITE_ROUTING_ROUTINGSCHEDULE_H_
+#define SATELLITE_ROUTING_ROUTINGSCHEDULE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace leolab {
+
+/**
+ * Precomputed, time-indexed first hop tables stored in a memory-mapped file.
+ *
+ * The schedule covers one period of a periodic topology (e.g. one orbital
+ * period of a circular-orbit constellation) with a fixed time step. For every
+ * step it stores a numNodes x numNodes table of int8_t entries: the output
+ * port (gate index) of the first hop from the source (row) to the destination
+ * (column), or NO_ROUTE for the source itself and unreachable destinations.
+ *
+ * The file starts with a fixed header that records the dimensions and a key
+ * identifying the inputs, so a stale file is detected and can be rebuilt.
+ * Opening the file maps it read-only; pages are loaded on demand, so replaying
+ * a schedule costs one lookup per route and no shortest path computation.
+ */
+class RoutingSchedule
+{
+  public:
+    typedef int8_t Entry;
+    static const Entry NO_ROUTE = -1;
+
+    /**
+     * Fills the first hop table of the given step (numNodes x numNodes
+     * entries, row = source).
+     */
+    typedef std::function<void(int step, Entry *table)> StepFunction;
+
+  protected:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        int32_t numNodes;
+        int32_t numSteps;
+        int32_t reserved;
+        double stepSize;                // seconds
+        double period;                  // seconds
+        uint64_t key;
+    };
+
+    void *data = nullptr;               // the mapped file
+    size_t size = 0;
+    const Header *header = nullptr;
+    const Entry *entries = nullptr;     // numSteps x numNodes x numNodes
+
+  public:
+    RoutingSchedule() { }
+    ~RoutingSchedule() { close(); }
+
+    RoutingSchedule(const RoutingSchedule&) = delete;
+    RoutingSchedule& operator=(const RoutingSchedule&) = delete;
+
+    /**
+     * Computes the tables of all steps with fillStep() and writes them to
+     * the given file. The file is written under a temporary name and renamed
+     * at the end, so readers never see a partial schedule.
+     */
+    static void write(const char *filename, uint64_t key, int numNodes, int numSteps, double stepSize, double period, const StepFunction& fillStep);
+
+    /**
+     * Maps the given file. Returns false if the file does not exist or was
+     * written for a different key; throws if it exists but is malformed.
+     */
+    bool open(const char *filename, uint64_t key);
+
+    /**
+     * Unmaps the file.
+     */
+    void close();
+
+    bool isOpen() const { return data != nullptr; }
+    int getNumNodes() const { return header->numNodes; }
+    int getNumSteps() const { return header->numSteps; }
+    double getStepSize() const { return header->stepSize; }
+    double getPeriod() const { return header->period; }
+
+    /**
+     * Returns the step that covers the given time (in seconds), taking the
+     * periodicity into account.
+     */
+    int getStep(double t) const;
+
+    /**
+     * Returns the start of the first step after the one that covers the
+     * given time, i.e. the next period * k + step * stepSize boundary. The
+     * last step of a period ends at the start of the next period, so a period
+     * that is not a multiple of stepSize does not shift later boundaries.
+     */
+    double getNextStepTime(double t) const;
+
+    /**
+     * Returns the first hop ports from the source node to all nodes in the
+     * given step.
+     */
+    const Entry *getRow(int step, int source) const { return entries + ((size_t)step * header->numNodes + source) * header->numNodes; }
+
+    /**
+     * Hashes the given bytes into the key (64-bit FNV-1a); start with
+     * key = 0 and feed all inputs the schedule depends on.
+     */
+    static uint64_t hash(uint64_t key, const void *bytes, size_t length);
+};
+
+} // namespace leolab
+
+#endif /* SATELLITE_ROUTING_ROUTINGSCHEDULE_H_ */
@@ -0,0 +1,172 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+
+#include "RoutingScheduleManager.h"
+#include "AllPairsShortestPaths.h"
+#include "../mobility/CircularOrbitMobility.h"
+#include <chrono>
+#include <cmath>
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+Define_Module(RoutingScheduleManager);
+
+RoutingScheduleManager::RoutingScheduleManager() { }
+
+RoutingScheduleManager::~RoutingScheduleManager() { }
+
+void RoutingScheduleManager::initialize()
+{
+    filename = par("filename").stdstringValue();
+    stepSize = par("stepSize").doubleValue();
+    rebuild = par("rebuild");
+    if (filename.empty())
+        throw cRuntimeError("RoutingScheduleManager: parameter filename is empty");
+    if (stepSize <= 0)
+        throw cRuntimeError("RoutingScheduleManager: parameter stepSize must be positive");
+    topologyManager.reference(this, "topologyManagerModule", true);
+}
+
+void RoutingScheduleManager::handleMessage(cMessage *msg)
+{
+    throw cRuntimeError("RoutingScheduleManager: this module does not process messages");
+}
+
+void RoutingScheduleManager::finish()
+{
+    schedule.close();
+}
+
+const RoutingSchedule *RoutingScheduleManager::getSchedule()
+{
+    if (!schedule.isOpen())
+        openOrBuildSchedule();
+    return &schedule;
+}
+
+void RoutingScheduleManager::openOrBuildSchedule()
+{
+    // 星间链路拓扑的私有副本，按采样时刻改写链路权重
+    CsrGraph graph = topologyManager->getTopology()->getCsrGraph();
+    int numNodes = graph.getNumNodes();
+    int numEdges = graph.getNumEdges();
+    if (numNodes == 0)
+        throw cRuntimeError("RoutingScheduleManager: the topology has no nodes");
+
+    // CSR 节点 -> 卫星下标，以及每颗卫星的轨道参数（由 WalkerDeltaTopologyConfigurator 写入 mobility 参数）
+    struct Orbit {
+        double initPhase, alpha, altitude, rightAscension, earthRotationRate;
+    };
+    std::vector<int> satelliteIndex(numNodes);
+    std::vector<Orbit> orbits(numNodes);
+    std::vector<uint8_t> seen(numNodes, 0);
+    for (int i = 0; i < numNodes; i++) {
+        cModule *node = getSimulation()->getModule(graph.getModuleId(i));
+        if (!node->isVector() || node->getVectorSize() != numNodes || seen[node->getIndex()])
+            throw cRuntimeError("RoutingScheduleManager: topology node %s is not an element of a %d-node vector", node->getFullPath().c_str(), numNodes);
+        CircularOrbitMobility *mobility = dynamic_cast<CircularOrbitMobility *>(node->getSubmodule("mobility"));
+        if (mobility == nullptr)
+            throw cRuntimeError("RoutingScheduleManager: %s does not use CircularOrbitMobility, its positions are not predictable", node->getFullPath().c_str());
+        int index = node->getIndex();
+        seen[index] = 1;
+        satelliteIndex[i] = index;
+        orbits[index] = { mobility->par("initPhase").doubleValue(), mobility->par("alpha").doubleValue(), mobility->par("altitude").doubleValue(),
+                          mobility->par("rightAscension").doubleValue(), mobility->par("earthRotationRate").doubleValue() };
+    }
+
+    // 每条边的出端口（宿主节点 ethg 门的下标）
+    std::vector<RoutingSchedule::Entry> edgePorts(numEdges);
+    for (int e = 0; e < numEdges; e++) {
+        cModule *node = getSimulation()->getModule(graph.getModuleId(graph.getEdgeSource(e)));
+        cGate *gate = node->gate(graph.getEdgeSourceGateId(e));
+        if (!gate->isVector() || gate->getIndex() > 127)
+            throw cRuntimeError("RoutingScheduleManager: link from gate %s cannot be stored in a routing schedule", gate->getFullPath().c_str());
+        edgePorts[e] = gate->getIndex();
+    }
+
+    // 所有卫星高度相同时，星间距离以轨道周期为周期（地球自转只使整个星座绕地轴旋转，不改变距离）
+    double omega = CircularOrbitMobility::computeAngularVelocity(orbits[0].altitude);
+    for (const Orbit& orbit : orbits)
+        if (orbit.altitude != orbits[0].altitude)
+            throw cRuntimeError("RoutingScheduleManager: satellites at different altitudes have no common period");
+    double period = 2 * M_PI / omega;
+    int numSteps = (int)std::ceil(period / stepSize);
+
+    // 与 TopologyManager 的其他路由模块采用相同的链路权重取法；
+    // 最小跳数时链路权重与时间无关，只写一步，period 为 0 表示该步一直有效
+    TopologyManager::LinkWeight linkWeight = topologyManager->getLinkWeight();
+    if (linkWeight == TopologyManager::HOPS) {
+        numSteps = 1;
+        period = 0;
+    }
+
+    // 调度表的键：采样参数、链路权重、轨道参数和链路集合
+    uint64_t key = RoutingSchedule::hash(0, &stepSize, sizeof(stepSize));
+    key = RoutingSchedule::hash(key, &linkWeight, sizeof(linkWeight));
+    key = RoutingSchedule::hash(key, &numNodes, sizeof(numNodes));
+    for (const Orbit& orbit : orbits)
+        key = RoutingSchedule::hash(key, &orbit, sizeof(orbit));
+    for (int e = 0; e < numEdges; e++) {
+        int link[4] = { satelliteIndex[graph.getEdgeSource(e)], satelliteIndex[graph.getEdgeDestination(e)], edgePorts[e], graph.isEdgeEnabled(e) };
+        key = RoutingSchedule::hash(key, link, sizeof(link));
+    }
+
+    if (!rebuild && schedule.open(filename.c_str(), key)) {
+        EV_INFO << "RoutingScheduleManager: using " << schedule.getNumSteps() << "-step routing schedule from " << filename << endl;
+        return;
+    }
+
+    EV_INFO << "RoutingScheduleManager: computing " << numSteps << " routing snapshot(s) of " << numNodes << " node(s) over a period of "
+            << period << "s into " << filename << endl;
+    auto start = std::chrono::steady_clock::now();
+    WorkerPool& pool = topologyManager->getWorkerPool();
+    AllPairsShortestPaths allPairs;
+    std::vector<GeodeticPosition> positions(numNodes);   // 按 CSR 节点编号的预测位置
+    RoutingSchedule::write(filename.c_str(), key, numNodes, numSteps, stepSize, period, [&] (int step, RoutingSchedule::Entry *table) {
+        double t = step * stepSize;
+        for (int i = 0; i < numNodes; i++) {
+            const Orbit& orbit = orbits[satelliteIndex[i]];
+            positions[i] = CircularOrbitMobility::computePosition(orbit.initPhase, orbit.alpha, orbit.altitude, orbit.rightAscension,
+                                                                  orbit.earthRotationRate, omega, t);
+        }
+
+        // 传播时延/链路长度由预测位置计算（最小跳数时只有一步，沿用 CSR 图的权重 1）
+        for (int e = 0; linkWeight != TopologyManager::HOPS && e < numEdges; e++) {
+            double distance = positions[graph.getEdgeSource(e)].distanceTo(positions[graph.getEdgeDestination(e)]);
+            graph.setEdgeWeight(e, linkWeight == TopologyManager::DELAY ? distance / SPEED_OF_LIGHT : distance);
+        }
+
+        allPairs.calculate(graph, pool);
+        for (int s = 0; s < numNodes; s++) {
+            RoutingSchedule::Entry *row = table + (size_t)satelliteIndex[s] * numNodes;
+            for (int d = 0; d < numNodes; d++) {
+                int edge = allPairs.getFirstHopEdge(s, d);
+                if (edge != -1)
+                    row[satelliteIndex[d]] = edgePorts[edge];
+            }
+        }
+    });
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    EV_INFO << "RoutingScheduleManager: routing schedule written in " << elapsed.count() << "s" << endl;
+
+    if (!schedule.open(filename.c_str(), key))
+        throw cRuntimeError("RoutingScheduleManager: cannot open the generated routing schedule '%s'", filename.c_str());
+}
+
+} // namespace leolab
@@ -0,0 +1,78 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+
+#ifndef SATELLITE_ROUTING_ROUTINGSCHEDULEMANAGER_H_
+#define SATELLITE_ROUTING_ROUTINGSCHEDULEMANAGER_H_
+
+#include <omnetpp.h>
+#include "inet/common/INETDefs.h"
+#include "inet/common/ModuleRefByPar.h"
+#include "RoutingSchedule.h"
+#include "TopologyManager.h"
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+/**
+ * 网络级预计算路由调度表服务。
+ * - 圆轨道 Walker 星座是周期性的：星间链路集合固定，链路时延只取决于卫星位置，
+ *   而卫星位置由 CircularOrbitMobility 的闭式公式给出
+ * - 第一次使用时，按 stepSize 对一个轨道周期采样，按 TopologyManager 的 linkWeight（
+ *   预测位置下的传播时延或链路长度）在其工作线程池上计算全源最短路径，把每个时刻每对卫星的
+ *   第一跳端口写入 filename；linkWeight 为跳数时路由与时间无关，只计算并写入一步
+ * - 链路集合取生成时 TopologyManager 的拓扑：当时已禁用的链路不参与计算，
+ *   之后在运行时启用/禁用链路不会反映到调度表中（需要跟随链路状态时使用按拓扑计算的路由模块）
+ * - 文件以内存映射方式只读打开，ScheduledRouting 按仿真时间直接查表，不再计算最短路径
+ * - 文件头记录由星座参数和链路集合计算的键，参数变化后自动重新生成；
+ *   同一配置的多次运行（如 10h 的 Trajectory）只需计算一次
+ */
+class RoutingScheduleManager : public cSimpleModule
+{
+  protected:
+    // ---------- 参数 ----------
+    std::string filename;               // 调度表文件路径
+    double stepSize = 0;                // 采样步长（s）
+    bool rebuild = false;               // 是否忽略已有文件、总是重新生成
+    ModuleRefByPar<TopologyManager> topologyManager;    // 提供星间链路拓扑和工作线程池
+
+    // ---------- 调度表 ----------
+    RoutingSchedule schedule;           // 内存映射的调度表
+
+  protected:
+    // OMNeT++ 生命周期
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+
+    // 打开已有的调度表，不存在或已过期时重新生成
+    virtual void openOrBuildSchedule();
+
+  public:
+    RoutingScheduleManager();
+    virtual ~RoutingScheduleManager();
+
+    /**
+     * 返回调度表，第一次调用时打开或生成。
+     * 节点编号为卫星在模块向量中的下标，表项为第一跳的 ethg 门下标。
+     */
+    const RoutingSchedule *getSchedule();
+};
+
+} // namespace leolab
+
+#endif /* SATELLITE_ROUTING_ROUTINGSCHEDULEMANAGER_H_ */
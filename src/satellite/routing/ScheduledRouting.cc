@@ -0,0 +1,116 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+
+#include "ScheduledRouting.h"
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+Define_Module(ScheduledRouting);
+
+ScheduledRouting::ScheduledRouting() { }
+
+ScheduledRouting::~ScheduledRouting()
+{
+    cancelAndDelete(stepTimer);
+}
+
+void ScheduledRouting::initialize(int stage)
+{
+    IdealRoutingBase::initialize(stage);
+
+    if (stage == INITSTAGE_LOCAL) {
+        routingSchedule.reference(this, "routingScheduleModule", true);
+        stepTimer = new cMessage("Scheduled-step");
+    }
+}
+
+void ScheduledRouting::handleMessage(cMessage *msg)
+{
+    if (msg == stepTimer)
+        updateRoutingTable();
+    else
+        IdealRoutingBase::handleMessage(msg);
+}
+
+void ScheduledRouting::finish()
+{
+    cancelAndDelete(stepTimer);
+    stepTimer = nullptr;
+    IdealRoutingBase::finish();
+}
+
+void ScheduledRouting::updateRoutingTable()
+{
+    // 查出当前采样步，与上次相同则已安装的路由仍然有效
+    const RoutingSchedule *schedule = routingSchedule->getSchedule();
+    double now = simTime().dbl();
+    int step = schedule->getStep(now);
+
+    // 下一次更新安排在调度表的下一个采样步边界（周期 * k + 步号 * stepSize），
+    // 而不是从 0 起按 stepSize 计时，周期不是步长的整数倍时也不会滞后
+    double next = schedule->getNextStepTime(now);
+    while (next != INFINITY && SimTime(next) <= simTime())
+        next = schedule->getNextStepTime(next);
+    if (next != INFINITY && stepTimer)
+        rescheduleAt(next, stepTimer);
+
+    if (step == scheduleStep)
+        return;
+    scheduleStep = step;
+
+    int numNodes = schedule->getNumNodes();
+    if (!host->isVector() || host->getVectorSize() != numNodes)
+        throw cRuntimeError("ScheduledRouting: host %s is not an element of the %d-node vector of the schedule", host->getFullPath().c_str(), numNodes);
+
+    // 调度表中的端口即 ethg 门下标，对应接口 eth<端口>
+    std::map<int, NetworkInterface *> portInterfaces;
+    const RoutingSchedule::Entry *row = schedule->getRow(step, host->getIndex());
+    cModule *network = host->getParentModule();
+    RouteMap wantedRoutes;
+    std::set<Ipv4Address> unreachableNetworks;
+    for (int i = 0; i < numNodes; ++i) {
+        if (i == host->getIndex()) continue;    // 跳过自己
+
+        // 取得目的节点 eth4 接口的子网
+        cModule *dstMod = network->getSubmodule(host->getName(), i);
+        Ipv4Address destNetwork, destMask;
+        findDestinationNetwork(dstMod, destNetwork, destMask);
+
+        int port = row[i];
+        if (port == RoutingSchedule::NO_ROUTE) {
+            EV_WARN << "Destination node " << dstMod->getFullPath() << " is unreachable" << endl;
+            unreachableNetworks.insert(destNetwork);
+            continue;
+        }
+
+        auto it = portInterfaces.find(port);
+        if (it == portInterfaces.end()) {
+            std::string ifName = "eth" + std::to_string(port);
+            NetworkInterface *intf = ift->findInterfaceByName(ifName.c_str());
+            if (!intf)
+                throw cRuntimeError("ScheduledRouting: %s has no interface %s", host->getFullPath().c_str(), ifName.c_str());
+            it = portInterfaces.insert(std::make_pair(port, intf)).first;
+        }
+        wantedRoutes[std::make_pair(destNetwork, destMask)] = it->second;
+    }
+
+    installRoutes(wantedRoutes, unreachableNetworks);
+}
+
+} // namespace leolab
@@ -0,0 +1,57 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+
+#ifndef SATELLITE_ROUTING_SCHEDULEDROUTING_H_
+#define SATELLITE_ROUTING_SCHEDULEDROUTING_H_
+
+#include "IdealRoutingBase.h"
+#include "RoutingScheduleManager.h"
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+/**
+ * 回放预计算路由调度表的路由模块。
+ * - 路由由 RoutingScheduleManager 在第一次使用时按轨道周期预先计算（链路权重取 TopologyManager 的 linkWeight），
+ *   运行时启用/禁用链路不会改变调度表
+ * - 在每个采样步的边界（按周期对齐）查出本节点那一行的第一跳端口并写入路由表，不计算最短路径
+ * - 只覆盖星间链路（卫星之间）的路由，适用于链路集合固定的圆轨道星座
+ */
+class ScheduledRouting : public IdealRoutingBase
+{
+  protected:
+    // ---------- 调度表 ----------
+    ModuleRefByPar<RoutingScheduleManager> routingSchedule;    // 网络级预计算路由调度表
+    int scheduleStep = -1;              // 上次写入路由表时使用的采样步
+    cMessage *stepTimer = nullptr;      // 在下一个采样步边界更新路由的自触发消息
+
+  protected:
+    virtual void initialize(int stage) override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+    virtual void updateRoutingTable() override;
+    virtual const char *getAlgorithmName() const override { return "Scheduled"; }
+
+  public:
+    ScheduledRouting();
+    virtual ~ScheduledRouting();
+};
+
+} // namespace leolab
+
+#endif /* SATELLITE_ROUTING_SCHEDULEDROUTING_H_ */
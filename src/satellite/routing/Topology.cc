@@ -21,12 +21,14 @@
 
 #include <algorithm>
 #include <deque>
-#include <list>
 #include <sstream>
+#include <unordered_map>
 
 #include "inet/common/PatternMatcher.h"
 #include "inet/common/stlutils.h"
 
+#include "IndexedHeap.h"
+
 namespace leolab {
 
 Register_Class(Topology);
@@ -53,7 +55,7 @@ Topology::Topology(const char *name) : cOwnedObject(name)
 
 Topology::Topology(const Topology& topo) : cOwnedObject(topo)
 {
-    throw cRuntimeError(this, "copy ctor not implemented yet");
+    copy(topo);
 }
 
 Topology::~Topology()
@@ -70,17 +72,176 @@ std::string Topology::str() const
 
 void Topology::parsimPack(cCommBuffer *buffer) const
 {
-    throw cRuntimeError(this, "parsimPack() not implemented");
+    cOwnedObject::parsimPack(buffer);
+
+    // nodes, in the order of nodes[]
+    int numNodes = nodes.size();
+    std::vector<int> moduleIds(numNodes), networkIds(numNodes);
+    std::vector<double> nodeWeights(numNodes);
+    std::vector<unsigned char> nodeEnabled(numNodes);
+    int numLinks = 0;
+    for (int i = 0; i < numNodes; i++) {
+        const Node *node = nodes[i];
+        moduleIds[i] = node->moduleId;
+        networkIds[i] = node->networkId;
+        nodeWeights[i] = node->weight;
+        nodeEnabled[i] = node->enabled;
+        numLinks += node->outLinks.size();
+    }
+
+    // links, grouped by source node in the order of Node::outLinks, i.e. in
+    // the order of the CSR edges; weights and enabled flags changed in place
+    // in a valid CSR graph are taken from there
+    const CsrGraph *graph = csrGraphValid ? &csrGraph : nullptr;
+    std::vector<int> linkSrc, linkDest, srcGateIds, destGateIds;
+    std::vector<double> linkWeights;
+    std::vector<unsigned char> linkEnabled;
+    linkSrc.reserve(numLinks);
+    linkDest.reserve(numLinks);
+    srcGateIds.reserve(numLinks);
+    destGateIds.reserve(numLinks);
+    linkWeights.reserve(numLinks);
+    linkEnabled.reserve(numLinks);
+    for (int i = 0; i < numNodes; i++) {
+        for (const Link *link : nodes[i]->outLinks) {
+            int e = linkSrc.size();
+            linkSrc.push_back(i);
+            linkDest.push_back(link->destNode->index);
+            srcGateIds.push_back(link->srcGateId);
+            destGateIds.push_back(link->destGateId);
+            linkWeights.push_back(graph ? graph->getEdgeWeight(e) : link->weight);
+            linkEnabled.push_back(graph ? graph->isEdgeEnabled(e) : link->enabled);
+        }
+    }
+
+    buffer->pack(numNodes);
+    buffer->pack(moduleIds.data(), numNodes);
+    buffer->pack(networkIds.data(), numNodes);
+    buffer->pack(nodeWeights.data(), numNodes);
+    buffer->pack(nodeEnabled.data(), numNodes);
+    buffer->pack(numLinks);
+    buffer->pack(linkSrc.data(), numLinks);
+    buffer->pack(linkDest.data(), numLinks);
+    buffer->pack(srcGateIds.data(), numLinks);
+    buffer->pack(destGateIds.data(), numLinks);
+    buffer->pack(linkWeights.data(), numLinks);
+    buffer->pack(linkEnabled.data(), numLinks);
 }
 
 void Topology::parsimUnpack(cCommBuffer *buffer)
 {
-    throw cRuntimeError(this, "parsimUnpack() not implemented");
+    cOwnedObject::parsimUnpack(buffer);
+    clear();
+
+    int numNodes;
+    buffer->unpack(numNodes);
+    std::vector<int> moduleIds(numNodes), networkIds(numNodes);
+    std::vector<double> nodeWeights(numNodes);
+    std::vector<unsigned char> nodeEnabled(numNodes);
+    buffer->unpack(moduleIds.data(), numNodes);
+    buffer->unpack(networkIds.data(), numNodes);
+    buffer->unpack(nodeWeights.data(), numNodes);
+    buffer->unpack(nodeEnabled.data(), numNodes);
+
+    int numLinks;
+    buffer->unpack(numLinks);
+    std::vector<int> linkSrc(numLinks), linkDest(numLinks), srcGateIds(numLinks), destGateIds(numLinks);
+    std::vector<double> linkWeights(numLinks);
+    std::vector<unsigned char> linkEnabled(numLinks);
+    buffer->unpack(linkSrc.data(), numLinks);
+    buffer->unpack(linkDest.data(), numLinks);
+    buffer->unpack(srcGateIds.data(), numLinks);
+    buffer->unpack(destGateIds.data(), numLinks);
+    buffer->unpack(linkWeights.data(), numLinks);
+    buffer->unpack(linkEnabled.data(), numLinks);
+
+    // the nodes arrive in the order of nodes[], so they need no sorting
+    nodes.reserve(numNodes);
+    for (int i = 0; i < numNodes; i++) {
+        Node *node = new Node(moduleIds[i]);
+        node->networkId = networkIds[i];
+        node->weight = nodeWeights[i];
+        node->enabled = nodeEnabled[i];
+        node->index = i;
+        nodes.push_back(node);
+    }
+    for (int e = 0; e < numLinks; e++) {
+        if (linkSrc[e] < 0 || linkSrc[e] >= numNodes || linkDest[e] < 0 || linkDest[e] >= numNodes)
+            throw cRuntimeError(this, "parsimUnpack(): invalid link %d", e);
+        Link *link = new Link(linkWeights[e]);
+        link->enabled = linkEnabled[e];
+        link->srcNode = nodes[linkSrc[e]];
+        link->srcGateId = srcGateIds[e];
+        link->destNode = nodes[linkDest[e]];
+        link->destGateId = destGateIds[e];
+        link->srcNode->outLinks.push_back(link);
+    }
+
+    // fill inLinks vectors, like extractFromNetwork()
+    for (auto& elem : nodes)
+        for (auto& link : elem->outLinks)
+            link->destNode->inLinks.push_back(link);
+
+    csrGraph.build(*this);
+    csrGraphValid = true;
 }
 
-Topology& Topology::operator=(const Topology&)
+Topology& Topology::operator=(const Topology& topo)
 {
-    throw cRuntimeError(this, "operator= not implemented yet");
+    if (this == &topo)
+        return *this;
+    cOwnedObject::operator=(topo);
+    copy(topo);
+    return *this;
+}
+
+void Topology::copy(const Topology& topo)
+{
+    clear();
+
+    // nodes keep their order, links keep their order in both inLinks and outLinks
+    std::unordered_map<const Node *, Node *> nodeMap;
+    std::unordered_map<const Link *, Link *> linkMap;
+    nodeMap.reserve(topo.nodes.size());
+    nodes.reserve(topo.nodes.size());
+    for (const Node *elem : topo.nodes) {
+        Node *node = new Node(elem->moduleId);
+        node->weight = elem->weight;
+        node->enabled = elem->enabled;
+        node->visited = elem->visited;
+        node->networkId = elem->networkId;
+        node->dist = elem->dist;
+        node->index = nodes.size();
+        nodeMap[elem] = node;
+        nodes.push_back(node);
+    }
+    for (const Node *elem : topo.nodes) {
+        Node *node = nodeMap.at(elem);
+        for (const Link *l : elem->outLinks) {
+            Link *link = new Link(l->weight);
+            link->enabled = l->enabled;
+            link->srcNode = node;
+            link->srcGateId = l->srcGateId;
+            link->destNode = nodeMap.at(l->destNode);
+            link->destGateId = l->destGateId;
+            linkMap[l] = link;
+            node->outLinks.push_back(link);
+        }
+    }
+
+    // incoming links and the results of the last shortest path search
+    for (const Node *elem : topo.nodes) {
+        Node *node = nodeMap.at(elem);
+        for (const Link *l : elem->inLinks)
+            node->inLinks.push_back(linkMap.at(l));
+        for (const Link *l : elem->outPaths)
+            node->outPaths.push_back(linkMap.at(l));
+        node->firstHopLink = elem->firstHopLink ? linkMap.at(elem->firstHopLink) : nullptr;
+    }
+
+    // the CSR graph may carry weights changed in place, so it is copied as is
+    csrGraph = topo.csrGraph;
+    csrGraphValid = topo.csrGraphValid;
 }
 
 void Topology::clear()
@@ -91,6 +252,23 @@ void Topology::clear()
         delete elem;
     }
     nodes.clear();
+    csrGraph.clear();
+    csrGraphValid = false;
+}
+
+const CsrGraph& Topology::getCsrGraph() const
+{
+    if (!csrGraphValid) {
+        csrGraph.build(*this);
+        csrGraphValid = true;
+    }
+    return csrGraph;
+}
+
+CsrGraph& Topology::getCsrGraphForUpdate()
+{
+    getCsrGraph();
+    return csrGraph;
 }
 
 // ---
@@ -99,11 +277,11 @@ static bool selectByModulePath(cModule *mod, void *data)
 {
     using inet::PatternMatcher;
 
-    // actually, this is selectByModuleFullPathPattern()
-    const std::vector<std::string>& v = *(const std::vector<std::string> *)data;
+    // actually, this is selectByModuleFullPathPattern(); the patterns are compiled once per extraction
+    const std::vector<PatternMatcher>& v = *(const std::vector<PatternMatcher> *)data;
     std::string path = mod->getFullPath();
     for (auto& elem : v)
-        if (PatternMatcher(elem.c_str(), true, true, true).matches(path.c_str()))
+        if (elem.matches(path.c_str()))
             return true;
 
     return false;
@@ -146,7 +324,34 @@ static bool selectByParameter(cModule *mod, void *data)
 
 void Topology::extractByModulePath(const std::vector<std::string>& fullPathPatterns)
 {
-    extractFromNetwork(selectByModulePath, (void *)&fullPathPatterns);
+    std::vector<inet::PatternMatcher> matchers;
+    matchers.reserve(fullPathPatterns.size());
+    for (auto& pattern : fullPathPatterns)
+        matchers.emplace_back(pattern.c_str(), true, true, true);
+    extractFromNetwork(selectByModulePath, (void *)&matchers);
+}
+
+void Topology::extractTopLevelByNedTypeName(const std::vector<std::string>& nedTypeNames, cModule *parent)
+{
+    extractFromSubmodules(selectByNedTypeName, (void *)&nedTypeNames, parent);
+}
+
+void Topology::extractBySubmoduleVector(const std::vector<std::string>& vectorNames, cModule *parent)
+{
+    if (!parent)
+        parent = getSimulation()->getSystemModule();
+
+    // the elements are addressed directly, no other module is looked at
+    std::vector<cModule *> modules;
+    for (auto& name : vectorNames) {
+        if (!parent->hasSubmoduleVector(name.c_str()))
+            throw cRuntimeError(this, "extractBySubmoduleVector(): %s has no submodule vector '%s'", parent->getFullPath().c_str(), name.c_str());
+        int size = parent->getSubmoduleVectorSize(name.c_str());
+        for (int i = 0; i < size; i++)
+            if (cModule *module = parent->getSubmodule(name.c_str(), i))
+                modules.push_back(module);
+    }
+    extractFromModules(modules);
 }
 
 void Topology::extractByNedTypeName(const std::vector<std::string>& nedTypeNames)
@@ -191,26 +396,53 @@ void Topology::extractFromNetwork(Predicate *predicate)
 
 void Topology::extractFromNetwork(bool (*predicate)(cModule *, void *), void *data)
 {
-    clear();
-
     // Loop through all modules and find those that satisfy the criteria
-    int networkId = 0;
+    std::vector<cModule *> modules;
     for (int modId = 0; modId <= getSimulation()->getLastComponentId(); modId++) {
         cModule *module = getSimulation()->getModule(modId);
-        if (module && predicate(module, data)) {
-            Node *node = createNode(module);
-            node->setNetworkId(++networkId);
-            nodes.push_back(node);
-        }
+        if (module && predicate(module, data))
+            modules.push_back(module);
+    }
+    extractFromModules(modules);
+}
+
+void Topology::extractFromSubmodules(bool (*predicate)(cModule *, void *), void *data, cModule *parent)
+{
+    if (!parent)
+        parent = getSimulation()->getSystemModule();
+
+    // Loop through the direct submodules only, not their submodule trees
+    std::vector<cModule *> modules;
+    for (cModule::SubmoduleIterator it(parent); !it.end(); it++)
+        if (predicate(*it, data))
+            modules.push_back(*it);
+    extractFromModules(modules);
+}
+
+void Topology::extractFromModules(std::vector<cModule *>& modules)
+{
+    clear();
+
+    // nodes[] must be ordered by module ID
+    std::sort(modules.begin(), modules.end(), [] (cModule *a, cModule *b) { return (unsigned int)a->getId() < (unsigned int)b->getId(); });
+    modules.erase(std::unique(modules.begin(), modules.end()), modules.end());
+
+    std::unordered_map<int, Node *> nodeFor;    // module ID -> node, for resolving the link endpoints
+    nodeFor.reserve(modules.size());
+    for (cModule *module : modules) {
+        Node *node = createNode(module);
+        node->index = nodes.size();
+        nodes.push_back(node);
+        nodeFor[module->getId()] = node;
     }
 
     // Discover out neighbors too.
-    for (auto& elem : nodes) {
+    for (size_t k = 0; k < nodes.size(); k++) {
         // Loop through all its gates and find those which come
         // from or go to modules included in the topology.
 
-        Node *node = elem;
-        cModule *mod = getSimulation()->getModule(node->moduleId);
+        Node *node = nodes[k];
+        cModule *mod = modules[k];
 
         for (cModule::GateIterator i(mod); !i.end(); i++) {
             cGate *gate = *i;
@@ -219,16 +451,17 @@ void Topology::extractFromNetwork(bool (*predicate)(cModule *, void *), void *da
 
             // follow path
             cGate *srcGate = gate;
+            auto destNode = nodeFor.end();
             do {
                 gate = gate->getNextGate();
-            } while (gate && !predicate(gate->getOwnerModule(), data));
+            } while (gate && (destNode = nodeFor.find(gate->getOwnerModule()->getId())) == nodeFor.end());
 
             // if we arrived at a module in the topology, record it.
             if (gate) {
                 Link *link = createLink();
                 link->srcNode = node;
                 link->srcGateId = srcGate->getId();
-                link->destNode = getNodeFor(gate->getOwnerModule());
+                link->destNode = destNode->second;
                 link->destGateId = gate->getId();
                 node->outLinks.push_back(link);
             }
@@ -243,27 +476,36 @@ void Topology::extractFromNetwork(bool (*predicate)(cModule *, void *), void *da
         }
     }
 
-    for (auto& elem : nodes)
-        findNetworks(elem);
+    csrGraph.build(*this);
+    csrGraphValid = true;
+    labelNetworks();
 }
 
 int Topology::addNode(Node *node)
 {
+    csrGraphValid = false;
+
     if (node->moduleId == -1) {
         // elements without module ID are stored at the end
+        node->index = nodes.size();
         nodes.push_back(node);
-        return nodes.size() - 1;
+        return node->index;
     }
     else {
         // must find an insertion point because nodes[] is ordered by module ID
         auto it = std::lower_bound(nodes.begin(), nodes.end(), node, lessByModuleId);
         it = nodes.insert(it, node);
-        return it - nodes.begin();
+        int index = it - nodes.begin();
+        for (size_t i = index; i < nodes.size(); i++)
+            nodes[i]->index = i;
+        return index;
     }
 }
 
 void Topology::deleteNode(Node *node)
 {
+    csrGraphValid = false;
+
     // remove outgoing links
     for (auto& elem : node->outLinks) {
         Link *link = elem;
@@ -283,13 +525,17 @@ void Topology::deleteNode(Node *node)
     // remove from nodes[]
     auto it = find(nodes, node);
     ASSERT(it != nodes.end());
-    nodes.erase(it);
+    it = nodes.erase(it);
+    for (size_t i = it - nodes.begin(); i < nodes.size(); i++)
+        nodes[i]->index = i;
 
     delete node;
 }
 
 void Topology::addLink(Link *link, Node *srcNode, Node *destNode)
 {
+    csrGraphValid = false;
+
     // remove from graph if it's already in
     if (link->srcNode)
         unlinkFromSourceNode(link);
@@ -309,6 +555,8 @@ void Topology::addLink(Link *link, Node *srcNode, Node *destNode)
 
 void Topology::addLink(Link *link, cGate *srcGate, cGate *destGate)
 {
+    csrGraphValid = false;
+
     // remove from graph if it's already in
     if (link->srcNode)
         unlinkFromSourceNode(link);
@@ -332,6 +580,8 @@ void Topology::addLink(Link *link, cGate *srcGate, cGate *destGate)
 
 void Topology::deleteLink(Link *link)
 {
+    csrGraphValid = false;
+
     unlinkFromSourceNode(link);
     unlinkFromDestNode(link);
     delete link;
@@ -380,6 +630,7 @@ void Topology::calculateUnweightedSingleShortestPathsTo(Node *_target) const
     for (auto& elem : nodes) {
         elem->dist = INFINITY;
         elem->outPaths.clear();
+        elem->firstHopLink = nullptr;
     }
     target->dist = 0;
 
@@ -429,14 +680,16 @@ void Topology::calculateWeightedSingleShortestPaths(Node *initial, bool to) cons
     for (auto& elem : nodes) {
         elem->dist = INFINITY;
         elem->outPaths.clear();
+        elem->firstHopLink = nullptr;
     }
     initial->dist = 0;
 
-    std::list<Node *> q;
-    q.push_back(initial);
-    while (!q.empty()) {
-        Node *current = q.front();
-        q.pop_front();
+    // priority queue with decrease-key, keyed by the index of the node in nodes[]
+    IndexedHeap<> q;
+    q.reset(nodes.size());
+    q.push(initial->index, 0);
+    while (!q.isEmpty()) {
+        Node *current = nodes[q.pop()];
         ASSERT(current->getWeight() >= 0.0);
 
         // for each w adjacent to v...
@@ -457,20 +710,17 @@ void Topology::calculateWeightedSingleShortestPaths(Node *initial, bool to) cons
             if (current != initial)
                 newdist += current->getWeight(); // current is not the target, uses weight of current node as price of routing (infinity means current node doesn't route between interfaces)
             if (newdist != INFINITY && remote->dist > newdist) { // it's a valid shorter path from remote to target node
-                if (remote->dist != INFINITY)
-                    q.remove(remote); // remote is in the queue
                 remote->dist = newdist;
                 // the first one will be the shortest
                 remote->outPaths.erase(std::remove(remote->outPaths.begin(), remote->outPaths.end(), to ? current->inLinks[i] : current->outLinks[i]), remote->outPaths.end());
                 remote->outPaths.insert(remote->outPaths.begin(), to ? current->inLinks[i] : current->outLinks[i]);
 
-                // insert remote node to ordered list
-                auto it = q.begin();
-                for (; it != q.end(); ++it)
-                    if ((*it)->dist > newdist)
-                        break;
+                // the first link from the source is inherited from current, so it is known for every node when the search ends
+                if (!to)
+                    remote->firstHopLink = current == initial ? current->outLinks[i] : current->firstHopLink;
 
-                q.insert(it, remote);
+                // insert remote node to the queue, or move it forward if it is already there
+                q.push(remote->index, newdist);
             }
             else if (!contains(remote->outPaths, to ? current->inLinks[i] : current->outLinks[i]))
                 (to ? remote : current)->outPaths.push_back(to ? current->inLinks[i] : current->outLinks[i]);
@@ -478,39 +728,65 @@ void Topology::calculateWeightedSingleShortestPaths(Node *initial, bool to) cons
     }
 }
 
-void Topology::findNetworks(Node *node)
+void Topology::calculateBellmanFordSingleShortestPathsFrom(Node *source) const
 {
-    if (node->isVisited())
-        return;
+    if (!source)
+        throw cRuntimeError(this, "calculateBellmanFordSingleShortestPathsFrom(): source node is nullptr");
 
-    cModule *mod = getSimulation()->getModule(node->moduleId);
-    if (!mod)
-        return;
-
-    for (cModule::GateIterator i(mod); !i.end(); i++) {
-        cGate *gate = *i;
-        if (gate->getType() != cGate::OUTPUT)
-            continue;
-
-        // follow path
-        do {
-            gate = gate->getNextGate();
-        } while (gate && !gate->getOwnerModule());
-
-        // if we arrived at a module in the topology, record it.
-        if (gate) {
-            node->setVisited(true);
-            Node *nextNode = getNodeFor(gate->getOwnerModule());
-            if (nextNode) {
-                if (!nextNode->isVisited()) {
-                    nextNode->setNetworkId(node->getNetworkId());
-                    findNetworks(nextNode);
+    for (auto& elem : nodes) {
+        elem->dist = INFINITY;
+        elem->outPaths.clear();
+        elem->firstHopLink = nullptr;
+    }
+    source->dist = 0;
+
+    // at most N-1 rounds of relaxing every link
+    for (size_t i = 0; i + 1 < nodes.size(); ++i) {
+        bool anyChange = false;
+        for (auto& elem : nodes) {
+            for (auto& link : elem->outLinks) {
+                Node *u = link->srcNode;
+                Node *v = link->destNode;
+                double w = link->weight;
+
+                // only relax from reachable nodes
+                if (u->dist != INFINITY && u->dist + w < v->dist) {
+                    v->dist = u->dist + w;
+                    v->outPaths.assign(1, link);  // only the last improvement is kept
+                    v->firstHopLink = u == source ? link : u->firstHopLink;
+                    anyChange = true;
                 }
             }
         }
+        // stop early if nothing was relaxed in this round
+        if (!anyChange) {
+            EV_INFO << "There is no change after " << i << " cycles" << endl;
+            break;
+        }
+    }
+
+    // Nth round: negative cycle detection
+    for (auto& elem : nodes) {
+        for (auto& link : elem->outLinks) {
+            Node *u = link->srcNode;
+            Node *v = link->destNode;
+            double w = link->weight;
+            if (u->dist != INFINITY && u->dist + w < v->dist)
+                throw cRuntimeError(this, "Bellman-Ford: negative weight cycle reachable from source node");
+        }
     }
 }
 
+void Topology::labelNetworks()
+{
+    // connected components of the extracted links (regardless of their enabled state),
+    // found by union-find on the CSR form, numbered from 1
+    std::vector<int> component;
+    csrGraph.calculateComponents(component, false);
+    for (size_t i = 0; i < nodes.size(); i++)
+        nodes[i]->setNetworkId(component[i] + 1);
+}
+
 } 
 
 
@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "inet/common/INETDefs.h"
+#include "CsrGraph.h"
 
 namespace leolab {
 
@@ -43,12 +44,14 @@ class Topology : public cOwnedObject
         bool enabled;
         bool visited;
         int networkId;
+        int index;              // position in Topology::nodes[], kept up to date by the topology
         std::vector<Link *> inLinks;
         std::vector<Link *> outLinks;
 
         // variables used by the shortest-path algorithms
         double dist;
         std::vector<Link *> outPaths;
+        Link *firstHopLink;     // first link of the path from the source (...From() searches)
         /**
          * Constructor
          */
@@ -58,7 +61,9 @@ class Topology : public cOwnedObject
             enabled = true;
             visited = false;
             networkId = 0;
+            index = -1;
             dist = INFINITY;
+            firstHopLink = nullptr;
         }
 
         virtual ~Node() {}
@@ -71,6 +76,12 @@ class Topology : public cOwnedObject
          */
         int getModuleId() const { return moduleId; }
 
+        /**
+         * Returns the position of this node in the topology, i.e. the index
+         * for Topology::getNode() and the node index in the CSR graph.
+         */
+        int getIndex() const { return index; }
+
         /**
          * Returns the pointer to the network module to which this node corresponds.
          */
@@ -91,6 +102,8 @@ class Topology : public cOwnedObject
         /**
          * Returns the ID of the network to which this node corresponds.
          * All nodes that belong to a connected network have the same network id.
+         * The extract...() functions number the networks from 1, in the order
+         * of their first node; see also CsrGraph::calculateComponents().
          */
         double getNetworkId() const { return networkId; }
 
@@ -173,6 +186,15 @@ class Topology : public cOwnedObject
          * length.)
          */
         Link *getPath(int i) const { return outPaths.at(i); }
+
+        /**
+         * Returns the first link of the shortest path from the source node to
+         * this node, i.e. the outgoing link of the source to use for this
+         * destination. Set by the ...ShortestPathsFrom() algorithms, which
+         * propagate it along with the distance, so no path has to be walked
+         * back afterwards. nullptr for the source and unreachable nodes.
+         */
+        Link *getFirstHopLink() const { return firstHopLink; }
         //@}
     };
 
@@ -300,13 +322,19 @@ class Topology : public cOwnedObject
   protected:
     std::vector<Node *> nodes;
 
+    // adjacency-array form of the graph, built on demand
+    mutable CsrGraph csrGraph;
+    mutable bool csrGraphValid = false;
+
     // note: the purpose of the (unsigned int) cast is that nodes with moduleId==-1 are inserted at the end of the vector
     static bool lessByModuleId(Node *a, Node *b) { return (unsigned int)a->moduleId < (unsigned int)b->moduleId; }
     static bool isModuleIdLess(Node *a, int moduleId) { return (unsigned int)a->moduleId < (unsigned int)moduleId; }
 
+    void copy(const Topology& topo);
+    void extractFromModules(std::vector<cModule *>& modules);
     void unlinkFromSourceNode(Link *link);
     void unlinkFromDestNode(Link *link);
-    void findNetworks(Node *);
+    void labelNetworks();
 
   public:
     /** @name Constructors, destructor, assignment */
@@ -318,7 +346,11 @@ class Topology : public cOwnedObject
     explicit Topology(const char *name = nullptr);
 
     /**
-     * Copy constructor.
+     * Copy constructor. Makes a deep copy of the nodes and links, together
+     * with the CSR graph (including weights and enabled flags changed in
+     * place), so the copy can serve as a snapshot of the topology. Nodes and
+     * links are copied as Node and Link; subclasses that create other types
+     * in createNode() or createLink() must redefine copying.
      */
     Topology(const Topology& topo);
 
@@ -328,7 +360,8 @@ class Topology : public cOwnedObject
     virtual ~Topology();
 
     /**
-     * Assignment operator. The name member is not copied; see cNamedObject's operator=() for more details.
+     * Assignment operator, makes a deep copy like the copy constructor.
+     * The name member is not copied; see cNamedObject's operator=() for more details.
      */
     Topology& operator=(const Topology& topo);
     //@}
@@ -352,6 +385,13 @@ class Topology : public cOwnedObject
      * Serializes the object into an MPI send buffer.
      * Used by the simulation kernel for parallel execution.
      * See cObject for more details.
+     *
+     * The nodes and links are packed as flat arrays: module IDs, network IDs,
+     * weights and enabled flags of the nodes, then source and destination
+     * node indices, gate IDs, weights and enabled flags of the links. Weights
+     * and enabled flags changed in place in a valid CSR graph are packed
+     * instead of those of the links. The state of the shortest path
+     * algorithms is not packed.
      */
     virtual void parsimPack(cCommBuffer *buffer) const override;
 
@@ -359,6 +399,9 @@ class Topology : public cOwnedObject
      * Deserializes the object from an MPI receive buffer
      * Used by the simulation kernel for parallel execution.
      * See cObject for more details.
+     *
+     * The CSR graph is rebuilt from the unpacked nodes and links. Module and
+     * gate IDs are only meaningful in a partition that has the same modules.
      */
     virtual void parsimUnpack(cCommBuffer *buffer) override;
     //@}
@@ -385,6 +428,14 @@ class Topology : public cOwnedObject
      */
     void extractFromNetwork(Predicate *predicate);
 
+    /**
+     * Like extractFromNetwork(selfunc, userdata), but only the direct
+     * submodules of the given parent (the network if nullptr) are offered to
+     * selfunc(). This avoids visiting the submodule trees of the nodes, which
+     * make up most of the modules of a large network.
+     */
+    void extractFromSubmodules(bool (*selfunc)(cModule *, void *), void *userdata = nullptr, cModule *parent = nullptr);
+
     /**
      * Extracts model topology by module full path. All modules whole getFullPath()
      * matches one of the patterns in given string vector will get included.
@@ -408,6 +459,21 @@ class Topology : public cOwnedObject
      */
     void extractByNedTypeName(const std::vector<std::string>& nedTypeNames);
 
+    /**
+     * Like extractByNedTypeName(), but only the direct submodules of the
+     * given parent (the network if nullptr) are considered.
+     */
+    void extractTopLevelByNedTypeName(const std::vector<std::string>& nedTypeNames, cModule *parent = nullptr);
+
+    /**
+     * Extracts model topology from the elements of the given submodule
+     * vectors of the given parent (the network if nullptr). The elements are
+     * addressed directly, so no other module is looked at.
+     *
+     * <tt>topo.extractBySubmoduleVector(cStringTokenizer("satelliteNode groundHost").asVector());</tt>
+     */
+    void extractBySubmoduleVector(const std::vector<std::string>& vectorNames, cModule *parent = nullptr);
+
     /**
      * Extracts model topology by a module property. All modules get included
      * that have a property with the given name and the given value
@@ -505,6 +571,31 @@ class Topology : public cOwnedObject
     Node *getNodeFor(cModule *mod) const;
     //@}
 
+    /** @name Compact graph representation. */
+    //@{
+
+    /**
+     * Returns the adjacency-array (CSR) form of the graph, with node indices
+     * matching getNode(int). It is built by the extract...() functions and
+     * rebuilt on demand after the graph has been manipulated. Weights and
+     * enabled flags later changed through Node and Link are only picked up
+     * after invalidateCsrGraph().
+     */
+    const CsrGraph& getCsrGraph() const;
+
+    /**
+     * Like getCsrGraph(), but allows changing weights and enabled flags
+     * in place.
+     */
+    CsrGraph& getCsrGraphForUpdate();
+
+    /**
+     * Marks the adjacency-array form as outdated, so it gets rebuilt on its
+     * next use.
+     */
+    void invalidateCsrGraph() { csrGraphValid = false; }
+    //@}
+
     /** @name Algorithms to find shortest paths. */
     /*
      * To be implemented:
@@ -534,6 +625,14 @@ class Topology : public cOwnedObject
     void calculateWeightedSingleShortestPathsTo(Node *target) const;
 
     void calculateWeightedSingleShortestPaths(Node *initial, bool to) const;
+
+    /**
+     * Apply the Bellman-Ford algorithm to find all shortest paths from the
+     * given graph node. The paths found can be extracted via Node's methods.
+     * Uses weights in links; throws an error if a negative weight cycle is
+     * reachable from the source.
+     */
+    void calculateBellmanFordSingleShortestPathsFrom(Node *source) const;
     //@}
 
   protected:
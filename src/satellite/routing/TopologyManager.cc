@@ -0,0 +1,339 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "TopologyManager.h"
+#include "inet/common/stlutils.h"
+#include "../wireless/DynamicChannel.h"
+#include <chrono>
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+Define_Module(TopologyManager);
+
+simsignal_t TopologyManager::topologyChangedSignal = registerSignal("topologyChanged");
+
+TopologyManager::TopologyManager() : topology("topology") { }
+
+TopologyManager::~TopologyManager()
+{
+    cancelAndDelete(linkWeightTimer);
+}
+
+void TopologyManager::initialize()
+{
+    nodeTypes = cStringTokenizer(par("nodeTypes")).asVector();
+    if (nodeTypes.empty())
+        throw cRuntimeError("TopologyManager: parameter nodeTypes is empty");
+    topLevelOnly = par("topLevelOnly");
+
+    int numThreads = par("numThreads");
+    if (numThreads < 0)
+        throw cRuntimeError("TopologyManager: parameter numThreads must not be negative");
+    workerPool.reset(new WorkerPool(numThreads));
+
+    std::string linkWeightName = par("linkWeight").stdstringValue();
+    if (linkWeightName == "hops")
+        linkWeight = HOPS;
+    else if (linkWeightName == "delay")
+        linkWeight = DELAY;
+    else if (linkWeightName == "distance")
+        linkWeight = DISTANCE;
+    else
+        throw cRuntimeError("TopologyManager: unknown linkWeight '%s'", linkWeightName.c_str());
+    linkWeightUpdateInterval = par("linkWeightUpdateInterval");
+    maxTreeMemory = par("maxTreeMemory");
+    if (linkWeightUpdateInterval < SIMTIME_ZERO)
+        throw cRuntimeError("TopologyManager: parameter linkWeightUpdateInterval must not be negative");
+    if (linkWeight != HOPS && linkWeightUpdateInterval > SIMTIME_ZERO) {
+        linkWeightTimer = new cMessage("linkWeightTimer");
+        scheduleAfter(linkWeightUpdateInterval, linkWeightTimer);
+    }
+
+    // 在网络顶层模块上订阅模型变化通知（信号会沿模块树向上传播）
+    cModule *network = getSimulation()->getSystemModule();
+    network->subscribe(PRE_MODEL_CHANGE, this);
+    network->subscribe(POST_MODEL_CHANGE, this);
+}
+
+void TopologyManager::handleMessage(cMessage *msg)
+{
+    if (msg != linkWeightTimer)
+        throw cRuntimeError("TopologyManager: unexpected message %s", msg->getName());
+    updateLinkWeights();
+    scheduleAfter(linkWeightUpdateInterval, linkWeightTimer);
+}
+
+void TopologyManager::finish()
+{
+    EV_INFO << "TopologyManager: " << numExtractions << " topology extraction(s), " << numIncrementalUpdates
+            << " incremental update(s), final epoch " << epoch << endl;
+
+    // 仿真结束后网络拆除时的模型变化无需处理
+    cModule *network = getSimulation()->getSystemModule();
+    network->unsubscribe(PRE_MODEL_CHANGE, this);
+    network->unsubscribe(POST_MODEL_CHANGE, this);
+
+    // 提前停止工作线程，不必等到模块析构
+    workerPool.reset();
+    cancelAndDelete(linkWeightTimer);
+    linkWeightTimer = nullptr;
+}
+
+const Topology *TopologyManager::getTopology()
+{
+    if (!topologyValid)
+        rebuild();
+    return &topology;
+}
+
+const AllPairsShortestPaths *TopologyManager::getAllPairsShortestPaths()
+{
+    const Topology *topo = getTopology();
+    if (allPairsValid && allPairsEpoch == epoch)
+        return &allPairs;
+
+    // CSR 图在仿真线程中构建完毕后，工作线程只读访问
+    const CsrGraph& graph = topo->getCsrGraph();
+    auto start = std::chrono::steady_clock::now();
+    // 完整的最短路径树（每对节点 16 字节）放得下时才保留，用于增量修复；否则只保留第一条边（每对节点 4 字节）
+    bool keepTrees = AllPairsShortestPaths::getTreeMemory(graph.getNumNodes()) <= maxTreeMemory;
+    if (!allPairsValid) {
+        allPairs.calculate(graph, *workerPool, keepTrees);
+        allPairsValid = true;
+        EV_INFO << "TopologyManager: computed " << graph.getNumNodes() << " shortest path trees for epoch " << epoch
+                << (keepTrees ? "" : " (first hops only)");
+    }
+    else if (!allPairs.hasTrees() || changedEdges.size() * 4 > (size_t)graph.getNumEdges()) {
+        // 没有保留完整的树，或大部分链路都变化时（如按时延周期刷新权重），整体重算比增量修复更快
+        allPairs.calculate(graph, *workerPool, keepTrees);
+        EV_INFO << "TopologyManager: " << changedEdges.size() << " changed link(s), recomputed " << graph.getNumNodes()
+                << " shortest path trees for epoch " << epoch;
+    }
+    else {
+        // 自上次计算以来只有链路权重/启用状态变化，增量修复
+        int numChangedTrees = allPairs.update(graph, changedEdges, *workerPool);
+        numIncrementalUpdates++;
+        EV_INFO << "TopologyManager: " << changedEdges.size() << " changed link(s) affected " << numChangedTrees
+                << " shortest path tree(s) for epoch " << epoch;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    EV_INFO << " on " << workerPool->getNumThreads() << " thread(s) in " << elapsed.count() << "s" << endl;
+    changedEdges.clear();
+    allPairsEpoch = epoch;
+    return &allPairs;
+}
+
+const std::vector<int>& TopologyManager::getComponents()
+{
+    const Topology *topo = getTopology();
+    if (componentsEpoch != epoch) {
+        numComponents = topo->getCsrGraph().calculateComponents(components);
+        componentsEpoch = epoch;
+        if (numComponents > 1)
+            EV_INFO << "TopologyManager: network is partitioned into " << numComponents << " components in epoch " << epoch << endl;
+    }
+    return components;
+}
+
+int TopologyManager::getComponentOf(cModule *module)
+{
+    const std::vector<int>& component = getComponents();
+    const CsrGraph& graph = topology.getCsrGraph();
+    if (isTopologyModule(module)) {
+        int node = graph.findNode(module->getId());
+        return node == -1 ? -1 : component[node];
+    }
+
+    // 沿模块的输出门找到所接入的拓扑节点（地面主机只有一条星地链路）
+    for (cModule::GateIterator i(module); !i.end(); i++) {
+        cGate *gate = *i;
+        if (gate->getType() != cGate::OUTPUT)
+            continue;
+        do {
+            gate = gate->getNextGate();
+        } while (gate && !isTopologyModule(gate->getOwnerModule()));
+        if (gate) {
+            int node = graph.findNode(gate->getOwnerModule()->getId());
+            if (node != -1 && component[node] != -1)
+                return component[node];
+        }
+    }
+    return -1;
+}
+
+void TopologyManager::invalidate()
+{
+    topologyValid = false;
+    advanceEpoch();
+    EV_INFO << "TopologyManager: topology invalidated, epoch is now " << epoch << endl;
+}
+
+void TopologyManager::advanceEpoch()
+{
+    epoch++;
+    emit(topologyChangedSignal, (intval_t)epoch);
+}
+
+bool TopologyManager::isTopologyModule(cModule *module) const
+{
+    if (module == nullptr || (topLevelOnly && module->getParentModule() != getSimulation()->getSystemModule()))
+        return false;
+    return contains(nodeTypes, std::string(module->getNedTypeName()));
+}
+
+void TopologyManager::setLinkWeight(int edge, double weight)
+{
+    getTopology();
+    CsrGraph& graph = topology.getCsrGraphForUpdate();
+    if (graph.getEdgeWeight(edge) == weight)
+        return;
+    graph.setEdgeWeight(edge, weight);
+    changedEdges.push_back(edge);
+    advanceEpoch();
+}
+
+void TopologyManager::setLinkEnabled(int edge, bool enabled)
+{
+    getTopology();
+    CsrGraph& graph = topology.getCsrGraphForUpdate();
+    if (graph.isEdgeEnabled(edge) == enabled)
+        return;
+    graph.setEdgeEnabled(edge, enabled);
+    changedEdges.push_back(edge);
+    advanceEpoch();
+    EV_INFO << "TopologyManager: link " << edge << (enabled ? " enabled" : " disabled") << ", epoch is now " << epoch << endl;
+}
+
+bool TopologyManager::updateLink(cGate *srcGate, cGate *destGate, bool enabled)
+{
+    // 尚未抽取或已失效的拓扑会在下次使用时整体重建，无需单独处理
+    if (!topologyValid)
+        return true;
+    const CsrGraph& graph = topology.getCsrGraph();
+    int srcNode = graph.findNode(srcGate->getOwnerModule()->getId());
+    if (srcNode == -1)
+        return false;
+    int edge = graph.findEdge(srcNode, srcGate->getId());
+    if (edge == -1 || graph.getEdgeDestinationGateId(edge) != destGate->getId()
+            || graph.getModuleId(graph.getEdgeDestination(edge)) != destGate->getOwnerModule()->getId())
+        return false;
+    setLinkEnabled(edge, enabled);
+    return true;
+}
+
+double TopologyManager::getChannelWeight(cGate *srcGate) const
+{
+    cChannel *channel = srcGate->findTransmissionChannel();
+
+    // 信道时延只在传输报文或收到位置信号时更新，读取前先按当前时间刷新，
+    // 否则没有流量经过的链路一直保留创建时的初始时延
+    if (DynamicChannel *dynamicChannel = dynamic_cast<DynamicChannel *>(channel))
+        dynamicChannel->refresh();
+
+    if (linkWeight == DISTANCE) {
+        DynamicChannel *dynamicChannel = dynamic_cast<DynamicChannel *>(channel);
+        if (dynamicChannel == nullptr)
+            throw cRuntimeError("TopologyManager: the link from %s has no DynamicChannel to take its distance from", srcGate->getFullPath().c_str());
+        return dynamicChannel->getDistance();
+    }
+    cDatarateChannel *datarateChannel = dynamic_cast<cDatarateChannel *>(channel);
+    if (datarateChannel == nullptr)
+        throw cRuntimeError("TopologyManager: the link from %s has no channel to take its delay from", srcGate->getFullPath().c_str());
+    return datarateChannel->getDelay().dbl();
+}
+
+int TopologyManager::updateLinkWeights()
+{
+    // 尚未抽取或已失效的拓扑会在重建时读取权重
+    if (linkWeight == HOPS || !topologyValid)
+        return 0;
+
+    CsrGraph& graph = topology.getCsrGraphForUpdate();
+    int numChangedEdges = 0;
+    for (int e = 0; e < graph.getNumEdges(); e++) {
+        cModule *node = getSimulation()->getModule(graph.getModuleId(graph.getEdgeSource(e)));
+        double weight = getChannelWeight(node->gate(graph.getEdgeSourceGateId(e)));
+        if (weight != graph.getEdgeWeight(e)) {
+            graph.setEdgeWeight(e, weight);
+            changedEdges.push_back(e);
+            numChangedEdges++;
+        }
+    }
+    if (numChangedEdges > 0) {
+        advanceEpoch();
+        EV_INFO << "TopologyManager: " << numChangedEdges << " link weight(s) updated from the channels, epoch is now " << epoch << endl;
+    }
+    return numChangedEdges;
+}
+
+void TopologyManager::rebuild()
+{
+    // 节点都是网络的直接子模块时，不必遍历整个模块树
+    if (topLevelOnly)
+        topology.extractTopLevelByNedTypeName(nodeTypes);
+    else
+        topology.extractByNedTypeName(nodeTypes);
+
+    // 抽取时按信道设置链路权重，CSR 图随后按新权重重建
+    if (linkWeight != HOPS) {
+        for (int i = 0; i < topology.getNumNodes(); i++) {
+            Topology::Node *node = topology.getNode(i);
+            for (int j = 0; j < node->getNumOutLinks(); j++) {
+                Topology::Link *link = node->getLinkOut(j);
+                link->setWeight(getChannelWeight(link->getLinkOutLocalGate()));
+            }
+        }
+        topology.invalidateCsrGraph();
+    }
+    topologyValid = true;
+    numExtractions++;
+    allPairsValid = false;
+    changedEdges.clear();
+    EV_INFO << "TopologyManager: extracted topology for epoch " << epoch << ", " << topology.str() << endl;
+}
+
+void TopologyManager::receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj, cObject *details)
+{
+    // 模块删除需在删除前判断类型，其余变化在完成后处理
+    if (signalID == PRE_MODEL_CHANGE) {
+        if (auto notification = dynamic_cast<cPreModuleDeleteNotification *>(obj))
+            if (isTopologyModule(notification->module))
+                invalidate();
+        return;
+    }
+
+    // 只有两端都属于拓扑节点的连接变化才影响拓扑（星地链路的切换不在其中）；
+    // 已抽取过的链路只启用/禁用对应的 CSR 边，其余情况重新抽取
+    if (auto notification = dynamic_cast<cPostGateConnectNotification *>(obj)) {
+        cGate *nextGate = notification->gate->getNextGate();
+        if (isTopologyModule(notification->gate->getOwnerModule()) && nextGate && isTopologyModule(nextGate->getOwnerModule()))
+            if (!updateLink(notification->gate, nextGate, true))
+                invalidate();
+    }
+    else if (auto notification = dynamic_cast<cPostGateDisconnectNotification *>(obj)) {
+        if (isTopologyModule(notification->gate->getOwnerModule()) && notification->targetGate && isTopologyModule(notification->targetGate->getOwnerModule()))
+            if (!updateLink(notification->gate, notification->targetGate, false))
+                invalidate();
+    }
+    else if (auto notification = dynamic_cast<cPostModuleAddNotification *>(obj)) {
+        if (isTopologyModule(notification->module))
+            invalidate();
+    }
+}
+
+} // namespace leolab
@@ -0,0 +1,178 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef SATELLITE_ROUTING_TOPOLOGYMANAGER_H_
+#define SATELLITE_ROUTING_TOPOLOGYMANAGER_H_
+
+#include <memory>
+#include <omnetpp.h>
+#include "inet/common/INETDefs.h"
+#include "Topology.h"
+#include "AllPairsShortestPaths.h"
+#include "WorkerPool.h"
+
+namespace leolab {
+
+using namespace omnetpp;
+using namespace inet;
+
+/**
+ * 网络级拓扑服务。
+ * - 每个拓扑版本（epoch）只抽取一次 Topology，供所有路由模块只读共享
+ * - 监听网络中的门连接/断开等模型变化，涉及拓扑节点时递增 epoch
+ * - 路由模块记录上次使用的 epoch，版本未变化时可直接跳过计算
+ * - 在工作线程池上并行计算全源最短路径，结果由各路由模块在仿真线程中写入路由表
+ * - 已有链路的权重变化与启用/禁用只在原地修改 CSR 图；完整的最短路径树在 maxTreeMemory 内时增量修复，否则整体重算
+ * - 链路权重可取信道的传播时延或链路长度（linkWeight），抽取时读取，之后可周期性原地刷新
+ * - 按 epoch 缓存连通分量（并查集，只计已启用的节点和链路），用于判断网络是否分割以及地面主机所在的分量
+ */
+class TopologyManager : public cSimpleModule, public cListener
+{
+  private:
+    // ---------- 拓扑快照 ----------
+    Topology topology;                  // 共享的拓扑快照
+    std::vector<std::string> nodeTypes; // 参与抽取的节点 NED 类型
+    bool topLevelOnly = true;           // 是否只考虑网络的直接子模块
+    int epoch = 0;                      // 当前拓扑版本号（结构变化与链路更新都会递增）
+    bool topologyValid = false;         // topology 是否反映当前的网络结构
+    int numExtractions = 0;             // 拓扑抽取次数（统计用）
+
+    // ---------- 全源最短路径 ----------
+    AllPairsShortestPaths allPairs;     // 每对节点间最短路径的第一条边（内存允许时保留完整的树）
+    double maxTreeMemory = 0;           // 保留完整最短路径树（用于增量修复）的内存上限（B）
+    bool allPairsValid = false;         // allPairs 是否基于当前抽取的拓扑
+    int allPairsEpoch = -1;             // allPairs 对应的拓扑版本号
+    std::vector<int> changedEdges;      // allPairs 计算后原地修改过的 CSR 边
+    int numIncrementalUpdates = 0;      // 增量修复次数（统计用）
+    std::unique_ptr<WorkerPool> workerPool; // 并行计算使用的工作线程池
+
+    // ---------- 连通分量 ----------
+    std::vector<int> components;        // 每个 CSR 节点所在的连通分量，禁用的节点为 -1
+    int numComponents = 0;              // 连通分量数
+    int componentsEpoch = -1;           // components 对应的拓扑版本号
+
+  public:
+    // ---------- 链路权重 ----------
+    enum LinkWeight {
+        HOPS,       // 所有链路权重为 1（最小跳数）
+        DELAY,      // 信道当前的传播时延（s）
+        DISTANCE    // DynamicChannel 最近一次计算的链路长度（m）
+    };
+
+  private:
+    LinkWeight linkWeight = HOPS;
+    simtime_t linkWeightUpdateInterval; // 从信道刷新链路权重的周期，0 表示只在抽取拓扑时读取
+    cMessage *linkWeightTimer = nullptr;    // 周期刷新链路权重的自触发消息
+
+    // ---------- 私有方法 ----------
+    bool isTopologyModule(cModule *module) const;   // 判断模块是否属于拓扑节点
+    void advanceEpoch();                            // 递增拓扑版本号并发出通知
+    void rebuild();                                 // 重新抽取拓扑
+    bool updateLink(cGate *srcGate, cGate *destGate, bool enabled); // 启用/禁用已有链路，找不到时返回 false
+    double getChannelWeight(cGate *srcGate) const;  // 由链路起点门所在连接的信道得到链路权重
+
+  protected:
+    // OMNeT++ 生命周期
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+
+    // cListener 接口，处理模型变化通知
+    virtual void receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj, cObject *details) override;
+
+  public:
+    // 拓扑版本号变化时发出的信号，值为新的版本号
+    static simsignal_t topologyChangedSignal;
+
+  public:
+    TopologyManager();
+    virtual ~TopologyManager();
+
+    /**
+     * 返回当前 epoch 的拓扑快照，必要时先重新抽取。
+     * 返回的拓扑由本模块持有，调用方只能只读使用。
+     */
+    const Topology *getTopology();
+
+    /**
+     * 返回当前 epoch 的全源最短路径结果（基于 getTopology() 的 CSR 图），
+     * 必要时先在工作线程池上重新计算。结果与线程数无关。
+     */
+    const AllPairsShortestPaths *getAllPairsShortestPaths();
+
+    /**
+     * 返回当前 epoch 的连通分量：components[CSR 节点索引] 为分量编号（从 0 开始），
+     * 只计已启用的节点和链路，不区分链路方向；禁用的节点为 -1。
+     */
+    const std::vector<int>& getComponents();
+
+    /**
+     * 返回当前 epoch 的连通分量数。
+     */
+    int getNumComponents() { getComponents(); return numComponents; }
+
+    /**
+     * 返回网络当前是否被分割为多个连通分量。
+     */
+    bool isPartitioned() { return getNumComponents() > 1; }
+
+    /**
+     * 返回模块所在的连通分量：拓扑节点取其自身的分量，其他节点（如地面主机）
+     * 取其链路所接入的拓扑节点的分量；不属于拓扑也未接入拓扑时返回 -1。
+     */
+    int getComponentOf(cModule *module);
+
+    /**
+     * 返回本模块的工作线程池，供路由模块并行计算单源最短路径；
+     * 只能在仿真线程上使用，同一时刻只能有一个 parallelFor()。
+     */
+    WorkerPool& getWorkerPool() { return *workerPool; }
+
+    /**
+     * 返回当前拓扑版本号，拓扑发生变化时递增。
+     */
+    int getEpoch() const { return epoch; }
+
+    /**
+     * 返回链路权重的取法（linkWeight 参数）。
+     */
+    LinkWeight getLinkWeight() const { return linkWeight; }
+
+    /**
+     * 使当前拓扑快照失效，下一次 getTopology() 时重新抽取。
+     */
+    void invalidate();
+
+    /**
+     * 原地修改 CSR 边的权重，不重新抽取拓扑；
+     * 下一次 getAllPairsShortestPaths() 时只修复受影响的最短路径树（保留了完整的树时）。
+     */
+    void setLinkWeight(int edge, double weight);
+
+    /**
+     * 原地启用/禁用 CSR 边（相当于链路的插入/删除），处理方式同 setLinkWeight()。
+     */
+    void setLinkEnabled(int edge, bool enabled);
+
+    /**
+     * 按 linkWeight 从各链路的信道重新读取权重，只原地修改发生变化的 CSR 边，
+     * 有变化时只递增一次 epoch。返回权重变化的边数。
+     */
+    int updateLinkWeights();
+};
+
+} // namespace leolab
+
+#endif /* SATELLITE_ROUTING_TOPOLOGYMANAGER_H_ */
@@ -0,0 +1,109 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#include "WorkerPool.h"
+
+namespace leolab {
+
+WorkerPool::WorkerPool(int numThreads)
+{
+    if (numThreads <= 0)
+        numThreads = std::thread::hardware_concurrency();
+    for (int i = 1; i < numThreads; i++)
+        workers.emplace_back(&WorkerPool::workerMain, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+void WorkerPool::workerMain()
+{
+    int seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping)
+                return;
+            seenGeneration = generation;
+        }
+        runLoop();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busyWorkers == 0)
+                done.notify_one();
+        }
+    }
+}
+
+void WorkerPool::runLoop()
+{
+    for (int i = nextIndex++; i < size; i = nextIndex++) {
+        try {
+            (*body)(i);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error)
+                error = std::current_exception();
+            nextIndex = size;   // skip the remaining indices
+        }
+    }
+}
+
+void WorkerPool::parallelFor(int n, const std::function<void(int)>& loopBody)
+{
+    if (n <= 0)
+        return;
+    if (workers.empty()) {
+        for (int i = 0; i < n; i++)
+            loopBody(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        body = &loopBody;
+        size = n;
+        nextIndex = 0;
+        error = nullptr;
+        busyWorkers = workers.size();
+        generation++;
+    }
+    wakeUp.notify_all();
+
+    runLoop();
+
+    std::exception_ptr loopError;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return busyWorkers == 0; });
+        body = nullptr;
+        loopError = error;
+        error = nullptr;
+    }
+    if (loopError)
+        std::rethrow_exception(loopError);
+}
+
+} // namespace leolab
@@ -0,0 +1,86 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+// 
+
+#ifndef SATELLITE_ROUTING_WORKERPOOL_H_
+#define SATELLITE_ROUTING_WORKERPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace leolab {
+
+/**
+ * Fixed-size pool of worker threads for data-parallel loops.
+ *
+ * The calling thread takes part in every loop, so a pool of one thread runs
+ * the loop inline without any synchronization. Loop bodies must only touch
+ * plain data (e.g. a CsrGraph and per-index result slots); they must not
+ * access modules, messages or any other simulation object.
+ */
+class WorkerPool
+{
+  protected:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeUp;     // signalled when a loop starts or the pool stops
+    std::condition_variable done;       // signalled when the last worker finished the loop
+
+    // the current loop
+    const std::function<void(int)> *body = nullptr;
+    int size = 0;
+    std::atomic<int> nextIndex {0};
+    int generation = 0;                 // incremented for every loop
+    int busyWorkers = 0;
+    bool stopping = false;
+    std::exception_ptr error;           // first exception thrown by the loop body
+
+  protected:
+    void workerMain();
+    void runLoop();
+
+  public:
+    /**
+     * Creates a pool that runs loops on numThreads threads, including the
+     * caller. Zero means one thread per hardware thread.
+     */
+    explicit WorkerPool(int numThreads);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * Returns the number of threads that run a loop, including the caller.
+     */
+    int getNumThreads() const { return workers.size() + 1; }
+
+    /**
+     * Calls loopBody(i) for every i in [0, n) and returns when all calls have
+     * finished. Indices are handed out dynamically, so the order of the calls
+     * is unspecified; results must be written to per-index slots. If a call
+     * throws, the remaining indices are skipped and the exception is
+     * rethrown in the caller.
+     */
+    void parallelFor(int n, const std::function<void(int)>& loopBody);
+};
+
+} // namespace leolab
+
+#endif /* SATELLITE_ROUTING_WORKERPOOL_H_ */
@@ -26,9 +26,8 @@ using namespace math;
 
 Define_Channel(DynamicChannel);
 
-const double EARTH_RADIUS_M = 6371000.0;
-
 DynamicChannel::DynamicChannel(const char *name) : cDatarateChannel(name) {
+    lastDistance = -1;
 }
 
 DynamicChannel::~DynamicChannel() {
@@ -55,6 +54,23 @@ void DynamicChannel::initParamerers() {
     // 订阅源节点和目标节点的移动性模块
     cModule *srcMobility = getMobilityModule(srcModule);
     cModule *destMobility = getMobilityModule(destModule);
+
+    // 惰性或节拍模式的卫星不逐颗发射位置信号，不订阅，更新时延时直接读取其当前位置
+    srcOrbit = dynamic_cast<CircularOrbitMobility *>(srcMobility);
+    if (srcOrbit && !srcOrbit->isLazy() && !srcOrbit->isTickDriven())
+        srcOrbit = nullptr;
+    destOrbit = dynamic_cast<CircularOrbitMobility *>(destMobility);
+    if (destOrbit && !destOrbit->isLazy() && !destOrbit->isTickDriven())
+        destOrbit = nullptr;
+
+    // 节拍模式：订阅星座位置服务每个节拍只发出一次的信号
+    ConstellationManager *ticker = nullptr;
+    if (srcOrbit && srcOrbit->isTickDriven())
+        ticker = srcOrbit->getConstellationManager();
+    else if (destOrbit && destOrbit->isTickDriven())
+        ticker = destOrbit->getConstellationManager();
+    if (ticker)
+        ticker->subscribe(ConstellationManager::constellationMovedSignal, this);
     
     // 添加空指针检查
     if (srcModule == nullptr) {
@@ -72,8 +88,9 @@ void DynamicChannel::initParamerers() {
             srcPosition.latitude = srcModule->par("initialLongitude");
             srcPosition.altitude = srcModule->par("initialAltitude");
             srcPosition.timestamp = simTime();
+            srcPosition.updateCartesian();
         }
-        else {
+        else if (srcOrbit == nullptr) {
             try {
                 // 源节点订阅信号
                 // ...
@@ -100,8 +117,9 @@ void DynamicChannel::initParamerers() {
             destPosition.latitude = destModule->par("initialLongitude");
             destPosition.altitude = destModule->par("initialAltitude");
             destPosition.timestamp = simTime();
+            destPosition.updateCartesian();
         }
-        else {
+        else if (destOrbit == nullptr) {
             try {
                 // 目的节点订阅信号
                 // ...
@@ -149,18 +167,12 @@ void DynamicChannel::receiveSignal(cComponent *source, simsignal_t signalID, cOb
         
         // 更新对应节点的位置缓存
         if (nodeModule == srcModule) {
-            srcPosition.longitude = geoPos->longitude;
-            srcPosition.latitude = geoPos->latitude;
-            srcPosition.altitude = geoPos->altitude;
-            srcPosition.timestamp = geoPos->timestamp;
+            srcPosition = *geoPos;
             
             EV_DEBUG << "Updated source position: " << srcPosition.str() << endl;
         }
         else if (nodeModule == destModule) {
-            destPosition.longitude = geoPos->longitude;
-            destPosition.latitude = geoPos->latitude;
-            destPosition.altitude = geoPos->altitude;
-            destPosition.timestamp = geoPos->timestamp;
+            destPosition = *geoPos;
             
             EV_DEBUG << "Updated destination position: " << destPosition.str() << endl;
         }
@@ -172,6 +184,12 @@ void DynamicChannel::receiveSignal(cComponent *source, simsignal_t signalID, cOb
     }
 }
 
+void DynamicChannel::receiveSignal(cComponent *source, simsignal_t signalID, intval_t value, cObject *details)
+{
+    if (signalID == ConstellationManager::constellationMovedSignal)
+        updateChannelDelay();
+}
+
 DynamicChannel::Result DynamicChannel::processMessage(cMessage *msg, const SendOptions& options, simtime_t t) {
 
     updateChannelDelay();
@@ -186,9 +204,15 @@ void DynamicChannel::updateChannelDelay() {
     if (lastUpdateTime >= 0 && (currentTime - lastUpdateTime) < minUpdateInterval) {
         return;
     }
+
+    // 惰性或节拍模式的端点：读取当前位置（同一时刻只计算一次）
+    if (srcOrbit)
+        srcPosition = *srcOrbit->getCurrentGeoPos();
+    if (destOrbit)
+        destPosition = *destOrbit->getCurrentGeoPos();
     
     // 计算距离
-    double distance = calculateDistance(srcPosition.longitude, srcPosition.latitude, srcPosition.altitude, destPosition.longitude, destPosition.latitude, destPosition.altitude);
+    double distance = calculateDistance(srcPosition, destPosition);
     
     // 更新信道时延
     double newDelay = distance / propagationSpeed;
@@ -201,28 +225,17 @@ void DynamicChannel::updateChannelDelay() {
     lastUpdateTime = currentTime;
 }
 
-double DynamicChannel::calculateDistance(double lon1, double lat1, double alt1, double lon2, double lat2, double alt2) {
-    // 将角度转换为弧度
-    double lat1_rad = math::deg2rad(lat1);
-    double lon1_rad = math::deg2rad(lon1);
-    double lat2_rad = math::deg2rad(lat2);
-    double lon2_rad = math::deg2rad(lon2);
-    
-    // 计算空间直线距离（考虑地球曲率和卫星高度）
-    double r1 = EARTH_RADIUS_M + alt1 * 1000.0;  // 转换为米
-    double r2 = EARTH_RADIUS_M + alt2 * 1000.0;
-    
-    // 球坐标转直角坐标
-    double x1 = r1 * cos(lat1_rad) * cos(lon1_rad);
-    double y1 = r1 * cos(lat1_rad) * sin(lon1_rad);
-    double z1 = r1 * sin(lat1_rad);
-    
-    double x2 = r2 * cos(lat2_rad) * cos(lon2_rad);
-    double y2 = r2 * cos(lat2_rad) * sin(lon2_rad);
-    double z2 = r2 * sin(lat2_rad);
-    
-    // 欧几里得距离
-    double distance = sqrt(pow(x2 - x1, 2) + pow(y2 - y1, 2) + pow(z2 - z1, 2));
+void DynamicChannel::refresh() {
+    updateChannelDelay();
+}
+
+double DynamicChannel::getDistance() const {
+    return lastDistance >= 0 ? lastDistance : getDelay().dbl() * propagationSpeed;
+}
+
+double DynamicChannel::calculateDistance(const GeodeticPosition& position1, const GeodeticPosition& position2) {
+    // 两端位置都带有地心直角坐标，只需做差和开方
+    double distance = position1.distanceTo(position2);
     
     EV_TRACE << "Spherical distance calculated: " << distance / 1000.0 << " km" << endl;
     
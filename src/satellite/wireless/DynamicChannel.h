@@ -19,6 +19,7 @@
 #include <omnetpp.h>
 #include "inet/common/INETDefs.h"
 #include "../common/TypeDefs.h"
+#include "../mobility/CircularOrbitMobility.h"
 
 namespace leolab {
 
@@ -39,6 +40,9 @@ class DynamicChannel : public cDatarateChannel, public cListener {
         simsignal_t geodeticPositionChangedSignal;
         GeodeticPosition srcPosition;
         GeodeticPosition destPosition;
+        // 惰性或节拍模式的端点不逐颗发射位置信号，更新时延时直接读取其当前位置
+        CircularOrbitMobility *srcOrbit = nullptr;
+        CircularOrbitMobility *destOrbit = nullptr;
         double lastDistance;
 
     protected:
@@ -47,9 +51,11 @@ class DynamicChannel : public cDatarateChannel, public cListener {
         virtual Result processMessage(cMessage *msg, const SendOptions& options, simtime_t t) override;
         // cListener接口 - 核心信号处理函数
         virtual void receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj, cObject *details) override;
+        // 星座节拍信号：全部卫星已推进，读取两端位置并更新时延
+        virtual void receiveSignal(cComponent *source, simsignal_t signalID, intval_t value, cObject *details) override;
 
         void updateChannelDelay();
-        double calculateDistance(double lon1, double lat1, double alt1, double lon2, double lat2, double alt2);
+        double calculateDistance(const GeodeticPosition& position1, const GeodeticPosition& position2);
 
         // 辅助函数
         virtual cModule* getMobilityModule(cModule *module);    
@@ -62,6 +68,10 @@ class DynamicChannel : public cDatarateChannel, public cListener {
         void initParamerers();
 
         virtual double getNominalDatarate() const override;
+        // 最近一次计算的链路长度（m）；尚未收到两端位置时由当前（初始）时延换算
+        double getDistance() const;
+        // 按当前仿真时间刷新时延（受 minUpdateInterval 限制），供读取时延的模块在读取前调用
+        void refresh();
         virtual bool isDisabled() const override  {return flags & (1 << 10);}
 };
 